@@ -19,8 +19,10 @@
 
 #include <config.h>
 
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
 #include <sys/stat.h>
-#include <pwd.h>
 #include <limits.h>
 #include <webkit2/webkit2.h>
 #include <glib/gi18n.h>
@@ -28,60 +30,303 @@
 #include <json-c/json_tokener.h>
 #include <json-c/json_util.h>
 #include "cc-security-apps-panel.h"
+#include "cc-security-apps-registry.h"
 #include "cc-security-apps-resources.h"
 
+typedef struct _AppCall AppCall;
+
+typedef struct
+{
+  CcSecurityAppsPanel *panel;
+  gchar               *dbus_name;
+  gchar               *uri;
+  GtkWidget           *container;
+  GtkWidget           *web_view;
+  WebKitUserContentManager *manager;
+  guint                process;
+  gint64               hidden_since;
+  gboolean             frozen;
+  guint                generation;
+  GQueue               calls;
+  AppCall             *running;
+  gboolean             busy;
+  GCancellable        *cancellable;
+  gchar               *pending_conf;
+  GArray              *pending_ids;
+  guint                debounce_source;
+} SecurityAppTab;
+
+/* One request waiting for, or running on, the LSF client, and the page
+ * promises it settles. Calls for the same app run one at a time in
+ * arrival order. */
+struct _AppCall
+{
+  SecurityAppTab *tab;
+  CcLsfRequest   *request;
+  guint           generation;
+  GArray         *ids;
+  gboolean        is_set;
+  gboolean        refresh;
+  gboolean        prefetch;
+};
+
 struct _CcSecurityAppsPanel
 {
   CcPanel                   parent_instance;
 
   GtkWidget                *security_apps_notebook;
-  GtkWidget                *web_view[SECURITY_APPS_MAX];
-  gchar                    *app_dbus_name[SECURITY_APPS_MAX];
-  gint                      app_num;
-  WebKitUserContentManager *manager;
+  GPtrArray                *tabs;
+  WebKitWebContext         *web_context;
+  guint                     process_views[SECURITY_APPS_WEB_PROCESSES];
+  SecurityAppTab           *current_tab;
+  guint                     lru_source;
+#if GLIB_CHECK_VERSION(2, 64, 0)
+  GMemoryMonitor           *memory_monitor;
+#endif
+  WebKitUserScript         *lsf_api;
   gboolean                  lsf_installed;
+
+  GHashTable               *settings_cache;
+  guint                     cache_hits;
+  guint                     cache_misses;
+  GFileMonitor             *log_monitor;
+  gchar                    *log_path;
+  goffset                   log_offset;
+  GCancellable             *log_cancellable;
+  guint                     log_source;
+  gboolean                  log_reading;
+  gboolean                  log_again;
+
+  guint                     freeze_timeout;
+  guint                     discard_timeout;
+  guint                     hidden_max;
+
+  GKeyFile                 *usage;
+  gchar                    *usage_path;
+  gboolean                  usage_dirty;
+  guint                     usage_source;
+  guint                     warm_source;
 };
 
 G_DEFINE_TYPE (CcSecurityAppsPanel, cc_security_apps_panel, CC_TYPE_PANEL)
 
+enum
+{
+  PROP_0,
+  PROP_FREEZE_TIMEOUT,
+  PROP_DISCARD_TIMEOUT,
+  PROP_HIDDEN_MAX,
+  N_PROPS
+};
+
+static GParamSpec *properties[N_PROPS];
+
+static AppCall *
+app_call_new (SecurityAppTab *tab,
+              const char     *method,
+              GArray         *ids)
+{
+  AppCall *call;
+
+  call = g_new0 (AppCall, 1);
+  call->tab = tab;
+  call->generation = tab->generation;
+  call->ids = ids;
+  call->is_set = !g_strcmp0 (method, "lsf_set_settings");
+  call->request = cc_lsf_request_new (tab->dbus_name, method);
+
+  return call;
+}
+
 static void
-remove_localstorage (void)
+app_call_free (AppCall *call)
 {
-  char *home_dir = NULL;
-  char *localstorage_dir = NULL;
-  GDir *dir = NULL;
-  const char *dir_file = NULL;
-  char *target_file = NULL;
+  if (call->request)
+    cc_lsf_request_free (call->request);
+  if (call->ids)
+    g_array_unref (call->ids);
+  g_free (call);
+}
 
-  if (!(home_dir = getenv ("HOME")))
-    home_dir = getpwuid (getuid ())->pw_dir;
-  localstorage_dir = g_strconcat (home_dir, "/.local/share/webkitgtk/localstorage", NULL);
+static void lsf_msg_handler (WebKitUserContentManager *manager,
+                             WebKitJavascriptResult   *js_result,
+                             gpointer                  user_data);
 
-  dir = g_dir_open (localstorage_dir, 0, NULL);
-  if (dir)
+/* Each view has a content manager of its own, whose message handler is
+ * bound to the tab. A message is thus routed by the view that sent it,
+ * whatever the page claims to be. */
+static WebKitUserContentManager *
+security_app_tab_get_manager (SecurityAppTab *tab)
+{
+  if (!tab->manager)
   {
-    while ((dir_file = g_dir_read_name (dir)))
-    {
-      target_file = g_strconcat (localstorage_dir, "/", dir_file, NULL);
-      remove (target_file);
-      g_free (target_file);
-    }
+    tab->manager = webkit_user_content_manager_new ();
+    webkit_user_content_manager_add_script (tab->manager, tab->panel->lsf_api);
+    g_signal_connect (tab->manager, "script-message-received::lsfInterface",
+                      G_CALLBACK (lsf_msg_handler), tab);
+    webkit_user_content_manager_register_script_message_handler (tab->manager, "lsfInterface");
   }
-  g_dir_close (dir);
 
-  g_free (localstorage_dir);
+  return tab->manager;
+}
+
+static void
+security_app_tab_drop_manager (SecurityAppTab *tab)
+{
+  if (!tab->manager)
+    return;
+
+  g_signal_handlers_disconnect_by_data (tab->manager, tab);
+  webkit_user_content_manager_unregister_script_message_handler (tab->manager, "lsfInterface");
+  g_clear_object (&tab->manager);
+}
+
+static void security_app_tab_send_writes (SecurityAppTab *tab);
+
+static void
+security_app_tab_free (SecurityAppTab *tab)
+{
+  AppCall *call;
+
+  security_app_tab_drop_manager (tab);
+  security_app_tab_send_writes (tab);
+
+  /* Reads still running for the tab finish as cancelled and no longer
+   * look at it. */
+  if (tab->running)
+    g_cancellable_cancel (tab->cancellable);
+  g_object_unref (tab->cancellable);
+  while ((call = g_queue_pop_head (&tab->calls)))
+    app_call_free (call);
+  if (tab->pending_ids)
+    g_array_unref (tab->pending_ids);
+  g_free (tab->pending_conf);
+  g_free (tab->dbus_name);
+  g_free (tab->uri);
+  g_free (tab);
+}
+
+static void
+load_usage (CcSecurityAppsPanel *self)
+{
+  self->usage_path = g_build_filename (g_get_user_cache_dir (), "gnome-control-center",
+                                       "security-apps-usage", NULL);
+  self->usage = g_key_file_new ();
+  g_key_file_load_from_file (self->usage, self->usage_path, G_KEY_FILE_NONE, NULL);
+}
+
+static void
+save_usage (CcSecurityAppsPanel *self)
+{
+  gchar *dir;
+
+  if (!self->usage_dirty)
+    return;
+
+  dir = g_path_get_dirname (self->usage_path);
+  g_mkdir_with_parents (dir, 0700);
+  g_key_file_save_to_file (self->usage, self->usage_path, NULL);
+  g_free (dir);
+  self->usage_dirty = FALSE;
+}
+
+static gint
+get_usage (CcSecurityAppsPanel *self,
+           SecurityAppTab      *tab)
+{
+  return g_key_file_get_integer (self->usage, "usage", tab->dbus_name, NULL);
+}
+
+static gboolean
+usage_settled (gpointer user_data)
+{
+  CcSecurityAppsPanel *self = CC_SECURITY_APPS_PANEL (user_data);
+
+  self->usage_source = 0;
+  save_usage (self);
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Counts a visit to the tab. Visits are written out in batches, so
+ * that they survive a crash without a write per page switch. */
+static void
+record_usage (CcSecurityAppsPanel *self,
+              SecurityAppTab      *tab)
+{
+  g_key_file_set_integer (self->usage, "usage", tab->dbus_name, get_usage (self, tab) + 1);
+  self->usage_dirty = TRUE;
+  if (!self->usage_source)
+    self->usage_source = g_timeout_add_seconds (SECURITY_APPS_USAGE_SAVE_DELAY,
+                                                usage_settled, self);
+}
+
+static gint
+compare_usage (gconstpointer a,
+               gconstpointer b,
+               gpointer      user_data)
+{
+  CcSecurityAppsPanel *self = CC_SECURITY_APPS_PANEL (user_data);
+
+  return get_usage (self, *(SecurityAppTab **) b) - get_usage (self, *(SecurityAppTab **) a);
 }
 
 static void
 cc_security_apps_panel_dispose (GObject *object)
 {
-  int i;
   CcSecurityAppsPanel *self = CC_SECURITY_APPS_PANEL (object);
 
-  for (i = 0; i < self->app_num; i++)
-    webkit_web_view_run_javascript (WEBKIT_WEB_VIEW (WEBKIT_WEB_VIEW (self->web_view[i])),
-                                    "localStorage.clear()", NULL, NULL, NULL);
-  remove_localstorage ();
+  if (self->lru_source)
+  {
+    g_source_remove (self->lru_source);
+    self->lru_source = 0;
+  }
+  if (self->warm_source)
+  {
+    g_source_remove (self->warm_source);
+    self->warm_source = 0;
+  }
+  if (self->usage_source)
+  {
+    g_source_remove (self->usage_source);
+    self->usage_source = 0;
+  }
+  if (self->usage)
+  {
+    save_usage (self);
+    g_clear_pointer (&self->usage, g_key_file_unref);
+    g_clear_pointer (&self->usage_path, g_free);
+  }
+#if GLIB_CHECK_VERSION(2, 64, 0)
+  if (self->memory_monitor)
+  {
+    g_signal_handlers_disconnect_by_data (self->memory_monitor, self);
+    g_clear_object (&self->memory_monitor);
+  }
+#endif
+  self->current_tab = NULL;
+
+  g_clear_pointer (&self->tabs, g_ptr_array_unref);
+  g_clear_object (&self->web_context);
+  if (self->log_monitor)
+  {
+    g_signal_handlers_disconnect_by_data (self->log_monitor, self);
+    g_file_monitor_cancel (self->log_monitor);
+    g_clear_object (&self->log_monitor);
+  }
+  if (self->log_source)
+  {
+    g_source_remove (self->log_source);
+    self->log_source = 0;
+  }
+  if (self->log_cancellable)
+  {
+    g_cancellable_cancel (self->log_cancellable);
+    g_clear_object (&self->log_cancellable);
+  }
+  g_clear_pointer (&self->log_path, g_free);
+  g_clear_pointer (&self->settings_cache, g_hash_table_unref);
+  g_clear_pointer (&self->lsf_api, webkit_user_script_unref);
 
   G_OBJECT_CLASS (cc_security_apps_panel_parent_class)->dispose (object);
 }
@@ -122,99 +367,873 @@ get_info_dialog (void)
   return dialog;
 }
 
+/* Settles the promise the page is waiting on; the payload is passed as
+ * a JSON string and parsed on the page side. */
+static void
+send_reply (SecurityAppTab *tab,
+            gint            id,
+            gboolean        ok,
+            const char     *payload)
+{
+  GString *script;
+
+  if (!tab->web_view)
+    return;
+
+  script = g_string_new (NULL);
+  g_string_printf (script, "lsfReply(%d, %s, ", id, ok ? "true" : "false");
+  cc_lsf_json_quote (script, payload ? payload : "null");
+  g_string_append (script, ")");
+  webkit_web_view_run_javascript (WEBKIT_WEB_VIEW (tab->web_view),
+                                  script->str, NULL, NULL, NULL);
+  g_string_free (script, TRUE);
+}
+
+static void
+reply_all (AppCall    *call,
+           gboolean    ok,
+           const char *payload)
+{
+  guint i;
+
+  /* A reply for a page that has been discarded since is dropped. */
+  if (call->generation != call->tab->generation)
+    return;
+
+  for (i = 0; i < call->ids->len; i++)
+    send_reply (call->tab, g_array_index (call->ids, gint, i), ok, payload);
+}
+
+/* Some apps answer a write with the settings now in effect, in which
+ * case reading them back is not needed. */
+static gboolean
+response_has_settings (struct json_object *resp_obj)
+{
+  struct json_object *ret_obj;
+
+  if (json_object_object_get_ex (resp_obj, "app_conf", NULL))
+    return TRUE;
+
+  return json_object_object_get_ex (resp_obj, "return", &ret_obj) &&
+         json_object_object_get_ex (ret_obj, "app_conf", NULL);
+}
+
+static void app_call_dispatch (SecurityAppTab *tab);
+
+static void
+app_call_finished (GObject      *source,
+                   GAsyncResult *result,
+                   gpointer      user_data)
+{
+  struct json_object *resp_obj;
+  AppCall *call = user_data;
+  AppCall *readback;
+  SecurityAppTab *tab = call->tab;
+  CcSecurityAppsPanel *self;
+  GError *error = NULL;
+  char *response;
+  gint64 trace;
+
+  response = cc_lsf_client_call_finish (CC_LSF_CLIENT (source), result, &error);
+  if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED) || !tab)
+  {
+    /* The tab has been removed, or the panel is gone. */
+    g_clear_error (&error);
+    g_free (response);
+    app_call_free (call);
+    return;
+  }
+
+  self = tab->panel;
+  tab->running = NULL;
+  trace = cc_lsf_trace_begin ();
+  resp_obj = response ? json_tokener_parse (response) : NULL;
+  cc_lsf_trace_mark (trace, "Security apps", "Parse", "%s", tab->dbus_name);
+
+  /* Any write makes the cached settings stale, whatever its outcome. */
+  if (call->is_set)
+    g_hash_table_remove (self->settings_cache, tab->dbus_name);
+
+  if (error)
+  {
+    g_debug ("%s: %s", tab->dbus_name, error->message);
+    reply_all (call, FALSE, error->message);
+  }
+  else if (call->is_set && !response_has_settings (resp_obj))
+  {
+    /* Read the settings back before settling the writers' promises. */
+    readback = app_call_new (tab, "lsf_get_settings", call->ids);
+    readback->generation = call->generation;
+    call->ids = NULL;
+    g_queue_push_head (&tab->calls, readback);
+  }
+  else
+  {
+    reply_all (call, TRUE, json_object_get_string (resp_obj));
+    if (!call->is_set && resp_obj)
+      g_hash_table_replace (self->settings_cache,
+                            g_strdup (tab->dbus_name),
+                            g_strdup (json_object_get_string (resp_obj)));
+  }
+
+  json_object_put (resp_obj);
+  g_clear_error (&error);
+  g_free (response);
+  app_call_free (call);
+
+  tab->busy = FALSE;
+  app_call_dispatch (tab);
+}
+
+static void
+app_call_dispatch (SecurityAppTab *tab)
+{
+  CcSecurityAppsPanel *self = tab->panel;
+  AppCall *call;
+  CcLsfRequest *request;
+  const char *cached;
+
+  for (;;)
+  {
+    if (tab->busy || !(call = g_queue_pop_head (&tab->calls)))
+      return;
+
+    /* A read queued behind a prefetch may find the settings cached by
+     * the time it gets its turn. */
+    cached = g_hash_table_lookup (self->settings_cache, tab->dbus_name);
+    if (call->is_set || call->refresh || !cached)
+      break;
+
+    cc_lsf_trace_counter (CC_LSF_TRACE_CACHE_HITS, ++self->cache_hits);
+    reply_all (call, TRUE, cached);
+    app_call_free (call);
+  }
+
+  if (!call->is_set && !call->prefetch)
+    cc_lsf_trace_counter (CC_LSF_TRACE_CACHE_MISSES, ++self->cache_misses);
+  tab->busy = TRUE;
+  tab->running = call;
+  request = call->request;
+  call->request = NULL;
+  cc_lsf_client_call_async (cc_lsf_client_get_default (), request,
+                            tab->cancellable, app_call_finished, call);
+}
+
+/* Writes are debounced: only the last app_conf of a burst is sent, and
+ * every lsfSetSettings() promise of the burst settles with its result. */
+static gboolean
+queue_pending_set (SecurityAppTab *tab)
+{
+  AppCall *call;
+
+  if (tab->debounce_source)
+  {
+    g_source_remove (tab->debounce_source);
+    tab->debounce_source = 0;
+  }
+  if (!tab->pending_conf)
+    return FALSE;
+
+  call = app_call_new (tab, "lsf_set_settings", tab->pending_ids);
+  cc_lsf_json_add_raw (cc_lsf_request_get_body (call->request), "app_conf", tab->pending_conf);
+  g_clear_pointer (&tab->pending_conf, g_free);
+  tab->pending_ids = NULL;
+
+  g_queue_push_tail (&tab->calls, call);
+  return TRUE;
+}
+
+static void
+flush_pending_set (SecurityAppTab *tab)
+{
+  if (queue_pending_set (tab))
+    app_call_dispatch (tab);
+}
+
+static void
+orphan_set_finished (GObject      *source,
+                     GAsyncResult *result,
+                     gpointer      user_data)
+{
+  gchar *dbus_name = user_data;
+  GError *error = NULL;
+
+  g_free (cc_lsf_client_call_finish (CC_LSF_CLIENT (source), result, &error));
+  if (error)
+  {
+    g_debug ("%s: %s", dbus_name, error->message);
+    g_error_free (error);
+  }
+  g_free (dbus_name);
+}
+
+/* A tab going away still owes the app the settings its page has
+ * written, pending or queued; only their promises are lost. A write
+ * already running is left to finish on its own. */
+static void
+security_app_tab_send_writes (SecurityAppTab *tab)
+{
+  AppCall *call = tab->running;
+  GList *l;
+
+  if (call && call->is_set)
+  {
+    call->tab = NULL;
+    tab->running = NULL;
+  }
+
+  queue_pending_set (tab);
+  for (l = tab->calls.head; l; l = l->next)
+  {
+    call = l->data;
+    if (!call->is_set)
+      continue;
+
+    cc_lsf_client_call_async (cc_lsf_client_get_default (), call->request,
+                              NULL, orphan_set_finished, g_strdup (tab->dbus_name));
+    call->request = NULL;
+  }
+}
+
+static gboolean
+debounce_expired (gpointer user_data)
+{
+  SecurityAppTab *tab = user_data;
+
+  tab->debounce_source = 0;
+  flush_pending_set (tab);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+queue_set (SecurityAppTab *tab,
+           gint            id,
+           const char     *app_conf)
+{
+  if (!tab->pending_ids)
+    tab->pending_ids = g_array_new (FALSE, FALSE, sizeof (gint));
+  g_array_append_val (tab->pending_ids, id);
+
+  g_free (tab->pending_conf);
+  tab->pending_conf = g_strdup (app_conf);
+
+  if (tab->debounce_source)
+    g_source_remove (tab->debounce_source);
+  tab->debounce_source = g_timeout_add (SECURITY_APPS_SET_DEBOUNCE, debounce_expired, tab);
+}
+
 static void
 lsf_msg_handler (WebKitUserContentManager *manager,
                  WebKitJavascriptResult   *js_result,
                  gpointer                  user_data)
 {
   struct json_object *req_obj;
-  struct json_object *resp_obj;
   struct json_object *prop_obj;
-  lsf_user_data_t app_data;
-  const char *app_settings;
   const char *method;
   GtkWidget *dialog = NULL;
   JSCValue *val = webkit_javascript_result_get_js_value (js_result);
-  CcSecurityAppsPanel *self = CC_SECURITY_APPS_PANEL (user_data);
-  char *req_msg = NULL;
-  char *response = NULL;
-  char script[JSON_FILE_BUF_SIZE] = { 0, };
-  int ret;
-  int app_num;
+  SecurityAppTab *tab = user_data;
+  CcSecurityAppsPanel *self = tab->panel;
+  AppCall *call;
+  GArray *ids;
+  const char *cached;
+  gboolean refresh = FALSE;
+  char *message;
+  gint id;
 
-  app_num = gtk_notebook_get_current_page (GTK_NOTEBOOK (self->security_apps_notebook));
+  message = jsc_value_to_string (val);
+  req_obj = json_tokener_parse (message);
+  g_free (message);
+  if (!req_obj)
+    return;
 
-  if (self->lsf_installed)
+  json_object_object_get_ex (req_obj, "id", &prop_obj);
+  id = json_object_get_int (prop_obj);
+  if (id <= 0)
   {
-    req_obj = json_tokener_parse (jsc_value_to_string (val));
-    if (!req_obj)
-      return;
+    json_object_put (req_obj);
+    return;
+  }
 
+  if (self->lsf_installed)
+  {
     json_object_object_get_ex (req_obj, "method", &prop_obj);
     method = json_object_get_string (prop_obj);
-
-    req_msg = (char *) calloc (1, JSON_FILE_BUF_SIZE);
-    if (!strcmp (method, "lsf_set_settings"))
+    if (g_strcmp0 (method, "lsf_set_settings") && g_strcmp0 (method, "lsf_get_settings"))
     {
-      json_object_object_get_ex (req_obj, "app_conf", &prop_obj);
-      app_settings = json_object_get_string (prop_obj);
-      snprintf (req_msg, JSON_FILE_BUF_SIZE,
-                "{  \"to\": \"%s\",\
-                    \"from\": \"%s\",\
-                    \"access_token\": \"%s\",\
-                    \"function\": \"%s\",\
-                    \"app_conf\": %s   }",
-                self->app_dbus_name[app_num],
-                CC_DBUS_NAME,
-                lsf_panel_access_token,
-                method,
-                app_settings);
-      ret = lsf_send_message (lsf_panel_symm_key, req_msg, &response);
-    }
-    else if (!strcmp (method, "lsf_get_settings"))
-    {
-      snprintf (req_msg, JSON_FILE_BUF_SIZE,
-                "{  \"to\": \"%s\",\
-                    \"from\": \"%s\",\
-                    \"access_token\": \"%s\",\
-                    \"function\": \"%s\"  }",
-                self->app_dbus_name[app_num],
-                CC_DBUS_NAME,
-                lsf_panel_access_token,
-                method);
-      ret = lsf_send_message (lsf_panel_symm_key, req_msg, &response);
+      send_reply (tab, id, FALSE, "unknown method");
+      json_object_put (req_obj);
+      return;
     }
-    json_object_put (req_obj);
-    FREE (req_msg);
 
-    if (ret == LSF_MESSAGE_RE_AUTH)
+    if (!g_strcmp0 (method, "lsf_set_settings"))
     {
-      ret = lsf_auth (&app_data, CC_PASSPHRASE);
-      if (ret == LSF_AUTH_STAT_OK)
-      {
-        lsf_panel_symm_key = g_strdup (app_data.symm_key);
-        lsf_panel_access_token = g_strdup (app_data.access_token);
-      }
+      json_object_object_get_ex (req_obj, "app_conf", &prop_obj);
+      queue_set (tab, id, json_object_to_json_string_ext (prop_obj, JSON_C_TO_STRING_PLAIN));
+      json_object_put (req_obj);
+      return;
     }
-    else if (ret == LSF_MESSAGE_RESP_OK)
+
+    /* Reads are served from the cache unless the page asks for a
+     * refresh or earlier calls for the app are still pending, which
+     * keeps them ordered behind a write. */
+    flush_pending_set (tab);
+    if (json_object_object_get_ex (req_obj, "refresh", &prop_obj))
+      refresh = json_object_get_boolean (prop_obj);
+    cached = g_hash_table_lookup (self->settings_cache, tab->dbus_name);
+    if (cached && !refresh && !tab->busy && g_queue_is_empty (&tab->calls))
     {
-      resp_obj = json_tokener_parse (response);
-      snprintf(script, JSON_FILE_BUF_SIZE,
-               "localStorage.setItem('lsfMsg', '%s')",
-               json_object_get_string (resp_obj));
-      webkit_web_view_run_javascript (WEBKIT_WEB_VIEW (WEBKIT_WEB_VIEW (self->web_view[app_num])),
-                                      script, NULL, NULL, NULL);
-      json_object_put (resp_obj);
+      cc_lsf_trace_counter (CC_LSF_TRACE_CACHE_HITS, ++self->cache_hits);
+      send_reply (tab, id, TRUE, cached);
+      json_object_put (req_obj);
+      return;
     }
 
-    FREE (response);
+    ids = g_array_new (FALSE, FALSE, sizeof (gint));
+    g_array_append_val (ids, id);
+    call = app_call_new (tab, method, ids);
+    call->refresh = refresh;
+    g_queue_push_tail (&tab->calls, call);
+    app_call_dispatch (tab);
   }
   else
   {
+    send_reply (tab, id, FALSE, _("Security Framework not installed."));
     dialog = get_info_dialog ();
     gtk_dialog_run (GTK_DIALOG (dialog));
     gtk_widget_destroy (dialog);
   }
+
+  json_object_put (req_obj);
+}
+
+/* Views are spread over at most SECURITY_APPS_WEB_PROCESSES web
+ * processes: the first view of each slot spawns one, later views are
+ * attached to the least loaded slot through "related-view". */
+static GtkWidget *
+find_related_view (CcSecurityAppsPanel *self,
+                   guint               *process)
+{
+  SecurityAppTab *tab;
+  guint i, slot = 0;
+
+  for (i = 0; i < SECURITY_APPS_WEB_PROCESSES; i++)
+  {
+    if (self->process_views[i] == 0)
+    {
+      *process = i;
+      return NULL;
+    }
+    if (self->process_views[i] < self->process_views[slot])
+      slot = i;
+  }
+
+  *process = slot;
+  for (i = 0; i < self->tabs->len; i++)
+  {
+    tab = g_ptr_array_index (self->tabs, i);
+    if (tab->web_view && tab->process == slot)
+      return tab->web_view;
+  }
+
+  return NULL;
+}
+
+/* Tabs start out as an empty container; the web view and its page are
+ * only created the first time the tab is shown. */
+static gboolean
+security_app_tab_realize (CcSecurityAppsPanel *self,
+                          SecurityAppTab      *tab)
+{
+  GtkWidget *related;
+  gint64 trace;
+
+  if (tab->web_view)
+    return FALSE;
+
+  trace = cc_lsf_trace_begin ();
+  related = find_related_view (self, &tab->process);
+  if (related)
+    tab->web_view = g_object_new (WEBKIT_TYPE_WEB_VIEW,
+                                  "user-content-manager", security_app_tab_get_manager (tab),
+                                  "related-view", related,
+                                  NULL);
+  else
+    tab->web_view = g_object_new (WEBKIT_TYPE_WEB_VIEW,
+                                  "web-context", self->web_context,
+                                  "user-content-manager", security_app_tab_get_manager (tab),
+                                  NULL);
+  self->process_views[tab->process]++;
+
+  webkit_web_view_load_uri (WEBKIT_WEB_VIEW (tab->web_view), tab->uri);
+  gtk_container_add (GTK_CONTAINER (tab->container), tab->web_view);
+  gtk_widget_show (tab->web_view);
+  cc_lsf_trace_mark (trace, "Security apps", "Rebuild", "%s", tab->dbus_name);
+
+  return TRUE;
+}
+
+/* A hidden view is frozen by unloading its page: the web process drops
+ * the document and its scripts, but the view and its process stay, so
+ * thawing is a plain reload. Replies for the unloaded page are dropped. */
+static void
+security_app_tab_freeze (SecurityAppTab *tab)
+{
+  if (!tab->web_view || tab->frozen)
+    return;
+
+  webkit_web_view_load_uri (WEBKIT_WEB_VIEW (tab->web_view), "about:blank");
+  tab->generation++;
+  tab->frozen = TRUE;
+}
+
+static void
+security_app_tab_thaw (SecurityAppTab *tab)
+{
+  tab->hidden_since = 0;
+  if (!tab->web_view || !tab->frozen)
+    return;
+
+  webkit_web_view_load_uri (WEBKIT_WEB_VIEW (tab->web_view), tab->uri);
+  tab->frozen = FALSE;
+}
+
+/* Discarded views are destroyed outright; the tab falls back to its
+ * empty container and is realized again on the next switch. */
+static void
+security_app_tab_discard (CcSecurityAppsPanel *self,
+                          SecurityAppTab      *tab)
+{
+  if (!tab->web_view || tab == self->current_tab)
+    return;
+
+  self->process_views[tab->process]--;
+  gtk_widget_destroy (tab->web_view);
+  tab->web_view = NULL;
+  security_app_tab_drop_manager (tab);
+  tab->generation++;
+  tab->frozen = FALSE;
+  tab->hidden_since = 0;
+}
+
+static guint
+discard_hidden_tabs (CcSecurityAppsPanel *self,
+                     guint                keep)
+{
+  SecurityAppTab *tab, *oldest;
+  guint i, live, discarded = 0;
+
+  for (;;)
+  {
+    oldest = NULL;
+    live = 0;
+    for (i = 0; i < self->tabs->len; i++)
+    {
+      tab = g_ptr_array_index (self->tabs, i);
+      if (!tab->web_view || tab == self->current_tab)
+        continue;
+      live++;
+      if (!oldest || tab->hidden_since < oldest->hidden_since)
+        oldest = tab;
+    }
+    if (!oldest || live <= keep)
+      break;
+    security_app_tab_discard (self, oldest);
+    discarded++;
+  }
+
+  return discarded;
+}
+
+static gboolean
+lru_check (gpointer user_data)
+{
+  CcSecurityAppsPanel *self = CC_SECURITY_APPS_PANEL (user_data);
+  SecurityAppTab *tab;
+  gint64 now = g_get_monotonic_time ();
+  gint64 hidden;
+  guint i;
+
+  for (i = 0; i < self->tabs->len; i++)
+  {
+    tab = g_ptr_array_index (self->tabs, i);
+    if (!tab->web_view || tab == self->current_tab)
+      continue;
+
+    hidden = (now - tab->hidden_since) / G_USEC_PER_SEC;
+    if (hidden >= self->discard_timeout)
+      security_app_tab_discard (self, tab);
+    else if (hidden >= self->freeze_timeout)
+      security_app_tab_freeze (tab);
+  }
+  discard_hidden_tabs (self, self->hidden_max);
+
+  return G_SOURCE_CONTINUE;
+}
+
+#if GLIB_CHECK_VERSION(2, 64, 0)
+static void
+low_memory_warning (GMemoryMonitor             *monitor,
+                    GMemoryMonitorWarningLevel  level,
+                    gpointer                    user_data)
+{
+  CcSecurityAppsPanel *self = CC_SECURITY_APPS_PANEL (user_data);
+  guint discarded;
+
+  /* The memory is held by the web processes and given back as they
+   * tear the pages down, so there is nothing to measure from here. */
+  discarded = discard_hidden_tabs (self, 0);
+  g_debug ("memory warning %d: discarded %u hidden app views", level, discarded);
+}
+#endif
+
+static void read_lsf_log (CcSecurityAppsPanel *self);
+
+static void
+lsf_log_read_done (CcSecurityAppsPanel *self,
+                   GFileInputStream    *stream)
+{
+  if (stream)
+  {
+    g_input_stream_close_async (G_INPUT_STREAM (stream), G_PRIORITY_LOW, NULL, NULL, NULL);
+    g_object_unref (stream);
+  }
+
+  self->log_reading = FALSE;
+  if (self->log_again)
+  {
+    self->log_again = FALSE;
+    read_lsf_log (self);
+  }
+}
+
+/* LSF logs every message it routes. A settings write to an app from
+ * anywhere else, or a policy reload, makes the cached settings stale. */
+static void
+invalidate_from_log (CcSecurityAppsPanel *self,
+                     const char          *data,
+                     gsize                len)
+{
+  const char *line = data;
+  const char *nl;
+  gchar *buf;
+  gchar **args;
+
+  while ((nl = memchr (line, '\n', len - (line - data))))
+  {
+    buf = g_strndup (line, nl - line + 1);
+    line = nl + 1;
+    if (!(args = cc_lsf_log_parse_line (buf)))
+    {
+      g_free (buf);
+      continue;
+    }
+
+    if (cc_lsf_log_is_policy_reload (args))
+      g_hash_table_remove_all (self->settings_cache);
+    else if (strstr (args[DMSG_FUNC], "set_settings"))
+      g_hash_table_remove (self->settings_cache, args[DMSG_TO]);
+    g_strfreev (args);
+    g_free (buf);
+  }
+
+  /* A partially written line is picked up again on the next change,
+   * unless it alone fills a whole chunk. */
+  if (line == data && len == SECURITY_APPS_LOG_CHUNK)
+    line = data + len;
+  self->log_offset += line - data;
+}
+
+static void
+lsf_log_chunk_read (GObject      *source,
+                    GAsyncResult *result,
+                    gpointer      user_data)
+{
+  GFileInputStream *stream = G_FILE_INPUT_STREAM (source);
+  CcSecurityAppsPanel *self;
+  GError *error = NULL;
+  GBytes *bytes;
+  gsize len;
+
+  bytes = g_input_stream_read_bytes_finish (G_INPUT_STREAM (stream), result, &error);
+  if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+  {
+    g_error_free (error);
+    g_object_unref (stream);
+    return;
+  }
+  g_clear_error (&error);
+
+  self = CC_SECURITY_APPS_PANEL (user_data);
+  if (!bytes)
+  {
+    lsf_log_read_done (self, stream);
+    return;
+  }
+
+  len = g_bytes_get_size (bytes);
+  invalidate_from_log (self, g_bytes_get_data (bytes, NULL), len);
+  g_bytes_unref (bytes);
+
+  /* Keep going while the log has more than one chunk to catch up on. */
+  if (len == SECURITY_APPS_LOG_CHUNK &&
+      g_seekable_seek (G_SEEKABLE (stream), self->log_offset, G_SEEK_SET, NULL, NULL))
+  {
+    g_input_stream_read_bytes_async (G_INPUT_STREAM (stream), SECURITY_APPS_LOG_CHUNK,
+                                     G_PRIORITY_LOW, self->log_cancellable,
+                                     lsf_log_chunk_read, self);
+    return;
+  }
+
+  lsf_log_read_done (self, stream);
+}
+
+static void
+lsf_log_sized (GObject      *source,
+               GAsyncResult *result,
+               gpointer      user_data)
+{
+  GFileInputStream *stream = G_FILE_INPUT_STREAM (source);
+  CcSecurityAppsPanel *self;
+  GError *error = NULL;
+  GFileInfo *info;
+  goffset end;
+
+  info = g_file_input_stream_query_info_finish (stream, result, &error);
+  if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+  {
+    g_error_free (error);
+    g_object_unref (stream);
+    return;
+  }
+  g_clear_error (&error);
+
+  self = CC_SECURITY_APPS_PANEL (user_data);
+  if (!info)
+  {
+    lsf_log_read_done (self, stream);
+    return;
+  }
+
+  end = g_file_info_get_size (info);
+  g_object_unref (info);
+
+  /* Skip whatever was logged before the panel opened, and start over
+   * when the log has been rotated. */
+  if (self->log_offset < 0)
+    self->log_offset = end;
+  else if (self->log_offset > end)
+    self->log_offset = 0;
+
+  if (self->log_offset == end ||
+      !g_seekable_seek (G_SEEKABLE (stream), self->log_offset, G_SEEK_SET, NULL, NULL))
+  {
+    lsf_log_read_done (self, stream);
+    return;
+  }
+
+  g_input_stream_read_bytes_async (G_INPUT_STREAM (stream), SECURITY_APPS_LOG_CHUNK,
+                                   G_PRIORITY_LOW, self->log_cancellable,
+                                   lsf_log_chunk_read, self);
+}
+
+static void
+lsf_log_opened (GObject      *source,
+                GAsyncResult *result,
+                gpointer      user_data)
+{
+  CcSecurityAppsPanel *self;
+  GError *error = NULL;
+  GFileInputStream *stream;
+
+  stream = g_file_read_finish (G_FILE (source), result, &error);
+  if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+  {
+    g_error_free (error);
+    return;
+  }
+  g_clear_error (&error);
+
+  self = CC_SECURITY_APPS_PANEL (user_data);
+  if (!stream)
+  {
+    lsf_log_read_done (self, NULL);
+    return;
+  }
+
+  g_file_input_stream_query_info_async (stream, G_FILE_ATTRIBUTE_STANDARD_SIZE,
+                                        G_PRIORITY_LOW, self->log_cancellable,
+                                        lsf_log_sized, self);
+}
+
+/* Reads whatever was appended to the log since the last read, off the
+ * main thread. A change arriving meanwhile starts another pass once
+ * this one is done. */
+static void
+read_lsf_log (CcSecurityAppsPanel *self)
+{
+  GFile *file;
+
+  if (self->log_reading)
+  {
+    self->log_again = TRUE;
+    return;
+  }
+
+  self->log_reading = TRUE;
+  file = g_file_new_for_path (self->log_path);
+  g_file_read_async (file, G_PRIORITY_LOW, self->log_cancellable, lsf_log_opened, self);
+  g_object_unref (file);
+}
+
+static gboolean
+lsf_log_settled (gpointer user_data)
+{
+  CcSecurityAppsPanel *self = CC_SECURITY_APPS_PANEL (user_data);
+
+  self->log_source = 0;
+  read_lsf_log (self);
+
+  return G_SOURCE_REMOVE;
+}
+
+/* LSF starts a new log every day. What was logged to the old one after
+ * the last read is never looked at, so nothing cached can be trusted. */
+static void
+switch_lsf_log (CcSecurityAppsPanel *self,
+                GFile               *file)
+{
+  g_cancellable_cancel (self->log_cancellable);
+  g_object_unref (self->log_cancellable);
+  self->log_cancellable = g_cancellable_new ();
+  self->log_reading = FALSE;
+  self->log_again = FALSE;
+
+  g_free (self->log_path);
+  self->log_path = g_file_get_path (file);
+  self->log_offset = 0;
+  g_hash_table_remove_all (self->settings_cache);
+}
+
+/* Logs are named after the day, a later log sorts after the current. */
+static gboolean
+is_newer_lsf_log (CcSecurityAppsPanel *self,
+                  GFile               *file)
+{
+  gchar *name;
+  gchar *current;
+  gboolean newer;
+
+  name = g_file_get_basename (file);
+  current = g_path_get_basename (self->log_path);
+  newer = g_str_has_prefix (name, CC_LSF_LOG_PREFIX "-") &&
+          g_str_has_suffix (name, ".log") &&
+          strcmp (name, current) > 0;
+  g_free (current);
+  g_free (name);
+
+  return newer;
+}
+
+static void
+lsf_log_changed (GFileMonitor      *monitor,
+                 GFile             *file,
+                 GFile             *other_file,
+                 GFileMonitorEvent  event_type,
+                 gpointer           user_data)
+{
+  CcSecurityAppsPanel *self = CC_SECURITY_APPS_PANEL (user_data);
+  gchar *path;
+  gboolean current;
+
+  if (event_type != G_FILE_MONITOR_EVENT_CHANGED &&
+      event_type != G_FILE_MONITOR_EVENT_CREATED)
+    return;
+
+  path = g_file_get_path (file);
+  current = !g_strcmp0 (path, self->log_path);
+  g_free (path);
+  if (!current)
+  {
+    if (event_type != G_FILE_MONITOR_EVENT_CREATED || !is_newer_lsf_log (self, file))
+      return;
+    switch_lsf_log (self, file);
+  }
+
+  /* LSF appends a line per message, so the log changes in bursts. */
+  if (!self->log_source)
+    self->log_source = g_timeout_add (SECURITY_APPS_LOG_DEBOUNCE, lsf_log_settled, self);
+}
+
+/* The directory is watched rather than the log, to follow LSF to the
+ * next day's log. */
+static void
+watch_lsf_log (CcSecurityAppsPanel *self)
+{
+  GFile *dir;
+
+  self->log_path = cc_lsf_log_get_path ();
+  self->log_cancellable = g_cancellable_new ();
+  dir = g_file_new_for_path (CC_LSF_LOG_DIRECTORY);
+  self->log_monitor = g_file_monitor_directory (dir, G_FILE_MONITOR_NONE, NULL, NULL);
+  if (self->log_monitor)
+    g_signal_connect (self->log_monitor, "changed", G_CALLBACK (lsf_log_changed), self);
+  g_object_unref (dir);
+
+  /* Finds the end of the log; nothing before it is of interest. */
+  read_lsf_log (self);
+}
+
+/* Prefetches the settings of the most used apps and loads the page of
+ * the most used one that is not showing, hidden, so that switching to
+ * it is instant. At most SECURITY_APPS_PREFETCH_MAX reads and one web
+ * view are spent on it. */
+static gboolean
+warm_tabs (gpointer user_data)
+{
+  CcSecurityAppsPanel *self = CC_SECURITY_APPS_PANEL (user_data);
+  SecurityAppTab *tab, *warm = NULL;
+  GPtrArray *ranked;
+  AppCall *call;
+  guint i, prefetched = 0;
+
+  self->warm_source = 0;
+
+  ranked = g_ptr_array_sized_new (self->tabs->len);
+  for (i = 0; i < self->tabs->len; i++)
+    g_ptr_array_add (ranked, g_ptr_array_index (self->tabs, i));
+  g_ptr_array_sort_with_data (ranked, compare_usage, self);
+
+  for (i = 0; i < ranked->len && prefetched < SECURITY_APPS_PREFETCH_MAX; i++)
+  {
+    tab = g_ptr_array_index (ranked, i);
+    if (get_usage (self, tab) == 0)
+      break;
+
+    if (!warm && !tab->web_view)
+      warm = tab;
+
+    if (!self->lsf_installed || tab->busy || !g_queue_is_empty (&tab->calls) ||
+        g_hash_table_contains (self->settings_cache, tab->dbus_name))
+      continue;
+
+    call = app_call_new (tab, "lsf_get_settings", g_array_new (FALSE, FALSE, sizeof (gint)));
+    call->prefetch = TRUE;
+    g_queue_push_tail (&tab->calls, call);
+    app_call_dispatch (tab);
+    prefetched++;
+  }
+  g_ptr_array_unref (ranked);
+
+  if (warm)
+  {
+    /* Left loaded but hidden; the LRU policy freezes it in due course. */
+    security_app_tab_realize (self, warm);
+    warm->hidden_since = g_get_monotonic_time ();
+  }
+
+  return G_SOURCE_REMOVE;
 }
 
 static void
@@ -224,76 +1243,205 @@ page_changed_callback (GtkNotebook *notebook,
                        gpointer     user_data)
 {
   CcSecurityAppsPanel *self = CC_SECURITY_APPS_PANEL (user_data);
-  webkit_web_view_run_javascript (WEBKIT_WEB_VIEW (WEBKIT_WEB_VIEW (self->web_view[page_num])),
-                                  "localStorage.clear()", NULL, NULL, NULL);
-  webkit_web_view_run_javascript (WEBKIT_WEB_VIEW (self->web_view[page_num]),
-                                  "lsfGetSettings()", NULL, NULL, NULL);
+  SecurityAppTab *tab = NULL;
+  guint i;
+
+  /* Pages come and go with the registry, match them by widget. */
+  for (i = 0; self->tabs && i < self->tabs->len && !tab; i++)
+    if (((SecurityAppTab *) g_ptr_array_index (self->tabs, i))->container == page)
+      tab = g_ptr_array_index (self->tabs, i);
+  if (!tab)
+    return;
+
+  /* The user is driving now, stop warming in the background. */
+  if (self->warm_source)
+  {
+    g_source_remove (self->warm_source);
+    self->warm_source = 0;
+  }
+
+  if (self->current_tab != tab)
+  {
+    if (self->current_tab)
+      self->current_tab->hidden_since = g_get_monotonic_time ();
+    record_usage (self, tab);
+  }
+  self->current_tab = tab;
+  security_app_tab_thaw (tab);
+
+  security_app_tab_realize (self, tab);
+}
+
+static void
+add_tab (CcSecurityAppsPanel *self,
+         const char          *dbus_name)
+{
+  SecurityAppTab *tab;
+  gchar *app_name;
+
+  tab = g_new0 (SecurityAppTab, 1);
+  tab->panel = self;
+  tab->dbus_name = g_strdup (dbus_name);
+  tab->uri = cc_security_apps_registry_get_uri (dbus_name);
+  tab->cancellable = g_cancellable_new ();
+  tab->container = gtk_scrolled_window_new (NULL, NULL);
+  g_ptr_array_add (self->tabs, tab);
+
+  app_name = get_app_name (tab->dbus_name);
+  gtk_widget_show (tab->container);
+  gtk_notebook_append_page (GTK_NOTEBOOK (self->security_apps_notebook), tab->container, gtk_label_new (app_name));
+  free (app_name);
+}
+
+static void
+app_added (CcSecurityAppsPanel *self,
+           const char          *dbus_name)
+{
+  if (self->tabs)
+    add_tab (self, dbus_name);
+}
+
+static void
+app_removed (CcSecurityAppsPanel *self,
+             const char          *dbus_name)
+{
+  SecurityAppTab *tab;
+  guint i;
+
+  for (i = 0; self->tabs && i < self->tabs->len; i++)
+  {
+    tab = g_ptr_array_index (self->tabs, i);
+    if (g_strcmp0 (tab->dbus_name, dbus_name))
+      continue;
+
+    if (tab == self->current_tab)
+      self->current_tab = NULL;
+    if (tab->web_view)
+      self->process_views[tab->process]--;
+    g_hash_table_remove (self->settings_cache, tab->dbus_name);
+    gtk_notebook_remove_page (GTK_NOTEBOOK (self->security_apps_notebook),
+                              gtk_notebook_page_num (GTK_NOTEBOOK (self->security_apps_notebook),
+                                                     tab->container));
+    g_ptr_array_remove_index (self->tabs, i);
+    return;
+  }
 }
 
 static void
 cc_security_apps_panel_constructed (GObject *object)
 {
   CcSecurityAppsPanel *self = CC_SECURITY_APPS_PANEL (object);
-  WebKitUserScript *lsf_api;
-  GtkWidget *scrolled_window;
+  CcSecurityAppsRegistry *registry;
   const char *script;
-  GDir *dir = NULL;
-  const gchar *app_dir;
-  gchar *app_name;
-  gchar *app_html;
-  gchar *panel_html;
-  int app_num = 0;
+  GPtrArray *apps;
+  gint current;
+  guint i;
 
-  self->manager = webkit_user_content_manager_new ();
+  G_OBJECT_CLASS (cc_security_apps_panel_parent_class)->constructed (object);
 
-  script = "function lsfGetSettings() {\
-              let obj = { method: \"lsf_get_settings\" };\
-              window.webkit.messageHandlers.lsfInterface.postMessage(JSON.stringify(obj));\
-              return JSON.parse(localStorage.getItem('lsfMsg')); }\
+  /* Each call posts a numbered message and returns a promise that the
+   * native side settles through lsfReply(). Replies are run in the top
+   * frame, so that is the only frame the API is injected into. */
+  script = "var lsfPending = new Map(); var lsfSeq = 0;\
+            function lsfCall(obj) {\
+              return new Promise((resolve, reject) => {\
+                obj.id = ++lsfSeq;\
+                lsfPending.set(obj.id, { resolve: resolve, reject: reject });\
+                window.webkit.messageHandlers.lsfInterface.postMessage(JSON.stringify(obj)); }); }\
+            function lsfReply(id, ok, payload) {\
+              let p = lsfPending.get(id);\
+              if (!p) return;\
+              lsfPending.delete(id);\
+              if (ok) p.resolve(JSON.parse(payload));\
+              else p.reject(new Error(payload)); }\
+            function lsfGetSettings() {\
+              return lsfCall({ method: \"lsf_get_settings\" }); }\
+            function lsfRefreshSettings() {\
+              return lsfCall({ method: \"lsf_get_settings\", refresh: true }); }\
             function lsfSetSettings(arg) {\
-              let obj = { method: \"lsf_set_settings\",\
-                          app_conf: arg };\
-              window.webkit.messageHandlers.lsfInterface.postMessage(JSON.stringify(obj));\
-              localStorage.removeItem('lsfMsg');\
-              return lsfGetSettings(); }";
-  lsf_api = webkit_user_script_new (script, 0, 0, NULL, NULL);
-
-  dir = g_dir_open (LSF_CC_PANEL_DIR, 0, NULL);
-  while ((app_dir = g_dir_read_name (dir)) != NULL)
-  {
-    panel_html = g_strconcat (LSF_CC_PANEL_DIR, "/", g_strdup (app_dir), "/html/panel.html", NULL);
-    if (access (panel_html, R_OK))
-    {
-      g_free (panel_html);
-      continue;
-    }
-    self->app_dbus_name[app_num] = g_strdup (app_dir);
-    self->manager = webkit_user_content_manager_new ();
-    webkit_user_content_manager_add_script (self->manager, lsf_api);
-    g_signal_connect (self->manager, "script-message-received::lsfInterface",
-                      G_CALLBACK (lsf_msg_handler), self);
-    webkit_user_content_manager_register_script_message_handler (self->manager, "lsfInterface");
-
-    app_name = get_app_name (self->app_dbus_name[app_num]);
-    app_html = g_strconcat ("file://", panel_html, NULL);
-    scrolled_window = gtk_scrolled_window_new (NULL, NULL);
-    self->web_view[app_num] = webkit_web_view_new_with_user_content_manager (self->manager);
-    webkit_web_view_run_javascript (WEBKIT_WEB_VIEW (WEBKIT_WEB_VIEW (self->web_view[app_num])),
-                                    "localStorage.clear()", NULL, NULL, NULL);
-    webkit_web_view_load_uri (WEBKIT_WEB_VIEW (self->web_view[app_num]), app_html);
-    gtk_container_add (GTK_CONTAINER (scrolled_window), self->web_view[app_num++]);
-    gtk_notebook_append_page (GTK_NOTEBOOK (self->security_apps_notebook), scrolled_window, gtk_label_new (app_name));
-    g_free (app_name);
-    g_free (panel_html);
-    g_free (app_html);
+              return lsfCall({ method: \"lsf_set_settings\", app_conf: arg }); }";
+  self->lsf_api = webkit_user_script_new (script,
+                                         WEBKIT_USER_CONTENT_INJECT_TOP_FRAME,
+                                         WEBKIT_USER_SCRIPT_INJECT_AT_DOCUMENT_START,
+                                         NULL, NULL);
+
+  /* Page storage lives in memory only and goes away with the context. */
+  self->web_context = webkit_web_context_new_ephemeral ();
+  webkit_web_context_set_process_model (self->web_context,
+                                        WEBKIT_PROCESS_MODEL_MULTIPLE_SECONDARY_PROCESSES);
+
+  registry = cc_security_apps_registry_get_default ();
+  apps = cc_security_apps_registry_list_apps (registry);
+  for (i = 0; i < apps->len; i++)
+    add_tab (self, g_ptr_array_index (apps, i));
+  g_ptr_array_unref (apps);
+  g_signal_connect_object (registry, "app-added", G_CALLBACK (app_added), self, G_CONNECT_SWAPPED);
+  g_signal_connect_object (registry, "app-removed", G_CALLBACK (app_removed), self, G_CONNECT_SWAPPED);
+
+  current = gtk_notebook_get_current_page (GTK_NOTEBOOK (self->security_apps_notebook));
+  if (current >= 0)
+  {
+    self->current_tab = g_ptr_array_index (self->tabs, current);
+    record_usage (self, self->current_tab);
+    security_app_tab_realize (self, self->current_tab);
   }
   g_signal_connect_after (self->security_apps_notebook, "switch-page", G_CALLBACK (page_changed_callback), self);
-  g_dir_close (dir);
-  self->app_num = app_num;
+  self->warm_source = g_timeout_add_full (G_PRIORITY_LOW, SECURITY_APPS_WARM_DELAY,
+                                          warm_tabs, self, NULL);
 
   gtk_widget_show_all (self->security_apps_notebook);
 }
 
+static void
+cc_security_apps_panel_get_property (GObject    *object,
+                                     guint       prop_id,
+                                     GValue     *value,
+                                     GParamSpec *pspec)
+{
+  CcSecurityAppsPanel *self = CC_SECURITY_APPS_PANEL (object);
+
+  switch (prop_id)
+  {
+    case PROP_FREEZE_TIMEOUT:
+      g_value_set_uint (value, self->freeze_timeout);
+      break;
+    case PROP_DISCARD_TIMEOUT:
+      g_value_set_uint (value, self->discard_timeout);
+      break;
+    case PROP_HIDDEN_MAX:
+      g_value_set_uint (value, self->hidden_max);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+cc_security_apps_panel_set_property (GObject      *object,
+                                     guint         prop_id,
+                                     const GValue *value,
+                                     GParamSpec   *pspec)
+{
+  CcSecurityAppsPanel *self = CC_SECURITY_APPS_PANEL (object);
+
+  switch (prop_id)
+  {
+    case PROP_FREEZE_TIMEOUT:
+      self->freeze_timeout = g_value_get_uint (value);
+      break;
+    case PROP_DISCARD_TIMEOUT:
+      self->discard_timeout = g_value_get_uint (value);
+      break;
+    case PROP_HIDDEN_MAX:
+      self->hidden_max = g_value_get_uint (value);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
 static void
 cc_security_apps_panel_class_init (CcSecurityAppsPanelClass *klass)
 {
@@ -302,6 +1450,24 @@ cc_security_apps_panel_class_init (CcSecurityAppsPanelClass *klass)
 
   object_class->dispose = cc_security_apps_panel_dispose;
   object_class->constructed = cc_security_apps_panel_constructed;
+  object_class->get_property = cc_security_apps_panel_get_property;
+  object_class->set_property = cc_security_apps_panel_set_property;
+
+  /* How long, in seconds, a hidden app view stays loaded and then alive,
+   * and how many hidden views are kept at most. */
+  properties[PROP_FREEZE_TIMEOUT] =
+    g_param_spec_uint ("freeze-timeout", NULL, NULL,
+                       0, G_MAXUINT, SECURITY_APPS_FREEZE_TIMEOUT,
+                       G_PARAM_READWRITE | G_PARAM_CONSTRUCT | G_PARAM_STATIC_STRINGS);
+  properties[PROP_DISCARD_TIMEOUT] =
+    g_param_spec_uint ("discard-timeout", NULL, NULL,
+                       0, G_MAXUINT, SECURITY_APPS_DISCARD_TIMEOUT,
+                       G_PARAM_READWRITE | G_PARAM_CONSTRUCT | G_PARAM_STATIC_STRINGS);
+  properties[PROP_HIDDEN_MAX] =
+    g_param_spec_uint ("hidden-max", NULL, NULL,
+                       0, G_MAXUINT, SECURITY_APPS_HIDDEN_MAX,
+                       G_PARAM_READWRITE | G_PARAM_CONSTRUCT | G_PARAM_STATIC_STRINGS);
+  g_object_class_install_properties (object_class, N_PROPS, properties);
 
   gtk_widget_class_set_template_from_resource (widget_class, SECURITY_APPS_UI);
   gtk_widget_class_bind_template_child (widget_class, CcSecurityAppsPanel, security_apps_notebook);
@@ -310,22 +1476,24 @@ cc_security_apps_panel_class_init (CcSecurityAppsPanelClass *klass)
 static void
 cc_security_apps_panel_init (CcSecurityAppsPanel *self)
 {
-  int ret;
-
   g_resources_register (cc_security_apps_get_resource ());
   gtk_widget_init_template (GTK_WIDGET (self));
-  self->app_num = 0;
+  self->tabs = g_ptr_array_new_with_free_func ((GDestroyNotify) security_app_tab_free);
+  self->settings_cache = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+  self->log_offset = -1;
+  load_usage (self);
+  self->lru_source = g_timeout_add_seconds (SECURITY_APPS_LRU_INTERVAL, lru_check, self);
+#if GLIB_CHECK_VERSION(2, 64, 0)
+  self->memory_monitor = g_memory_monitor_dup_default ();
+  g_signal_connect (self->memory_monitor, "low-memory-warning",
+                    G_CALLBACK (low_memory_warning), self);
+#endif
 
   if (access (LSF_API, R_OK) == 0)
   {
-    lsf_user_data_t app_data;
     self->lsf_installed = TRUE;
-    ret = lsf_auth (&app_data, CC_PASSPHRASE);
-    if (ret == LSF_AUTH_STAT_OK)
-    {
-      lsf_panel_symm_key = g_strdup (app_data.symm_key);
-      lsf_panel_access_token = g_strdup (app_data.access_token);
-    }
+    watch_lsf_log (self);
+    cc_lsf_credentials_prefetch ();
   }
 }
 
@@ -26,19 +26,47 @@
 #include <lsf/lsf-auth.h>
 #include <lsf/lsf-dbus.h>
 
+#include "cc-lsf-client.h"
+#include "cc-lsf-credentials.h"
+#include "cc-lsf-log.h"
+#include "cc-lsf-trace.h"
+
 G_BEGIN_DECLS
 
 #define CC_TYPE_SECURITY_APPS_PANEL (cc_security_apps_panel_get_type ())
 G_DECLARE_FINAL_TYPE (CcSecurityAppsPanel, cc_security_apps_panel, CC, SECURITY_APPS_PANEL, CcPanel)
 
-#define LSF_CC_PANEL_DIR "/var/tmp/lsf/lsf-cc-panel"
 #define LSF_API          "/usr/lib/x86_64-linux-gnu/liblsf.so"
-#define CC_PASSPHRASE    "n6x6myibEAvfN9vIDDPQi+iCoE7yTuHP//eC195+g7w="
-#define SECURITY_APPS_MAX 1000
+#define SECURITY_APPS_WEB_PROCESSES 2
 
-#define SECURITY_APPS_UI "/org/gnome/control-center/security-apps/security-apps.ui"
+/* Defaults for the "freeze-timeout", "discard-timeout" and "hidden-max"
+ * properties: hidden app views are unloaded after
+ * SECURITY_APPS_FREEZE_TIMEOUT and destroyed after
+ * SECURITY_APPS_DISCARD_TIMEOUT seconds; at most
+ * SECURITY_APPS_HIDDEN_MAX of them are kept alive. */
+#define SECURITY_APPS_LRU_INTERVAL    10
+#define SECURITY_APPS_FREEZE_TIMEOUT  30
+#define SECURITY_APPS_DISCARD_TIMEOUT 300
+#define SECURITY_APPS_HIDDEN_MAX      3
+
+/* Quiet period, in milliseconds, before a burst of lsfSetSettings()
+ * calls from one app is sent as a single write. */
+#define SECURITY_APPS_SET_DEBOUNCE  300
+
+/* Delay, in milliseconds, before idle prefetching starts once the
+ * panel is shown, and how many app settings it may read ahead. */
+#define SECURITY_APPS_WARM_DELAY    1000
+#define SECURITY_APPS_PREFETCH_MAX  2
 
-#define CC_DBUS_NAME     "kr.gooroom.controlcenter"
+/* Delay, in seconds, before recorded app usage is written to disk. */
+#define SECURITY_APPS_USAGE_SAVE_DELAY 5
+
+/* Quiet period, in milliseconds, before changes to the LSF log are
+ * read, and the most read from it in one go. */
+#define SECURITY_APPS_LOG_DEBOUNCE  200
+#define SECURITY_APPS_LOG_CHUNK     65536
+
+#define SECURITY_APPS_UI "/org/gnome/control-center/security-apps/security-apps.ui"
 
 #define FREE(v) \
     if (v) { \
@@ -46,9 +74,6 @@ G_DECLARE_FINAL_TYPE (CcSecurityAppsPanel, cc_security_apps_panel, CC, SECURITY_
       v=NULL; \
     }
 
-gchar *lsf_panel_symm_key;
-gchar *lsf_panel_access_token;
-
 GtkWidget *cc_security_apps_panel_new (void);
 
 G_END_DECLS
@@ -0,0 +1,736 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/*
+ * Copyright (C) 2020 gooroom <gooroom@gooroom.kr>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <lsf/lsf-main.h>
+#include <lsf/lsf-util.h>
+#include <lsf/lsf-auth.h>
+#include <lsf/lsf-dbus.h>
+
+#include "cc-lsf-client.h"
+#include "cc-lsf-credentials.h"
+#include "cc-lsf-metrics.h"
+#include "cc-lsf-trace.h"
+
+/* Every LSF request of the control center goes through this client. The
+ * D-Bus connection itself is owned by liblsf; the client shares the
+ * process wide credentials, numbers requests for the debug log, renews a
+ * rejected token once and keeps counters for the panels.
+ *
+ * After CC_LSF_CLIENT_BREAKER_THRESHOLD consecutive send failures or
+ * timeouts the client stops calling into liblsf for a cool-down period
+ * and fails requests right away, then lets a single probe through.
+ *
+ * A timed out or cancelled call returns at once but its worker stays
+ * blocked in lsf_send_message. While CC_LSF_CLIENT_MAX_STUCK such
+ * workers are outstanding new calls are refused, so a hung daemon
+ * cannot use up the GTask thread pool. */
+struct _CcLsfClient
+{
+  GObject           parent_instance;
+
+  GMutex            lock;
+  CcLsfClientStats  stats;
+  guint             next_id;
+  guint             failures_in_row;
+  gint64            open_until;
+  guint             cooldown;
+  gboolean          probing;
+  gboolean          reachable;
+  guint             stuck;
+
+  gint64            latencies[CC_LSF_CLIENT_LATENCY_SAMPLES];
+  guint             latency_next;
+  guint             latency_count;
+};
+
+G_DEFINE_TYPE (CcLsfClient, cc_lsf_client, G_TYPE_OBJECT)
+
+enum
+{
+  PROP_0,
+  PROP_REACHABLE,
+  PROP_BREAKER_COOLDOWN,
+  N_PROPS
+};
+
+static GParamSpec *properties[N_PROPS];
+
+struct _CcLsfRequest
+{
+  gchar     *to;
+  gchar     *function;
+  CcLsfJson *body;
+  guint      timeout;
+};
+
+/* Writers are recycled so a steady stream of requests reuses the same
+ * buffers; an unusually large one is dropped instead of being kept. */
+static GMutex  pool_lock;
+static GSList *pool;
+static guint   pool_len;
+
+CcLsfRequest *
+cc_lsf_request_new (const char *to,
+                    const char *function)
+{
+  CcLsfRequest *request = g_new0 (CcLsfRequest, 1);
+
+  g_mutex_lock (&pool_lock);
+  if (pool)
+  {
+    request->body = pool->data;
+    pool = g_slist_delete_link (pool, pool);
+    pool_len--;
+  }
+  g_mutex_unlock (&pool_lock);
+
+  if (request->body == NULL)
+    request->body = cc_lsf_json_new ();
+
+  request->to = g_strdup (to);
+  request->function = g_strdup (function);
+  request->timeout = CC_LSF_CLIENT_TIMEOUT;
+
+  cc_lsf_json_begin_object (request->body, NULL);
+  cc_lsf_json_add_string (request->body, "to", to);
+  cc_lsf_json_add_string (request->body, "from", CC_LSF_DBUS_NAME);
+  cc_lsf_json_add_string (request->body, "function", function);
+
+  return request;
+}
+
+CcLsfJson *
+cc_lsf_request_get_body (CcLsfRequest *request)
+{
+  return request->body;
+}
+
+void
+cc_lsf_request_set_timeout (CcLsfRequest *request,
+                            guint         timeout)
+{
+  request->timeout = timeout;
+}
+
+void
+cc_lsf_request_free (CcLsfRequest *request)
+{
+  if (request == NULL)
+    return;
+
+  g_mutex_lock (&pool_lock);
+  if (pool_len < CC_LSF_CLIENT_POOL
+      && cc_lsf_json_get_capacity (request->body) <= CC_LSF_CLIENT_POOL_BUF)
+  {
+    cc_lsf_json_reset (request->body);
+    pool = g_slist_prepend (pool, request->body);
+    pool_len++;
+    request->body = NULL;
+  }
+  g_mutex_unlock (&pool_lock);
+
+  cc_lsf_json_free (request->body);
+  g_free (request->to);
+  g_free (request->function);
+  g_free (request);
+}
+
+typedef struct
+{
+  CcLsfClient  *client;
+  guint         id;
+  CcLsfRequest *request;
+  GCancellable *cancellable;
+  GCancellable *caller_cancellable;
+  gulong        cancelled_id;
+  GSource      *timeout_source;
+  gboolean      probe;
+  gboolean      timed_out;
+  gboolean      recorded;
+  gboolean      done;
+  gboolean      abandoned;
+} CcLsfCall;
+
+static void
+lsf_call_free (CcLsfCall *call)
+{
+  if (call->timeout_source)
+    g_source_unref (call->timeout_source);
+  if (call->caller_cancellable)
+  {
+    g_cancellable_disconnect (call->caller_cancellable, call->cancelled_id);
+    g_object_unref (call->caller_cancellable);
+  }
+  g_signal_handlers_disconnect_by_data (call->cancellable, call);
+  g_object_unref (call->cancellable);
+  cc_lsf_request_free (call->request);
+  g_free (call);
+}
+
+static gboolean
+notify_reachable (gpointer user_data)
+{
+  g_object_notify_by_pspec (G_OBJECT (user_data), properties[PROP_REACHABLE]);
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Sets probe if the call is the one let through a breaker that has
+ * cooled down. */
+static gboolean
+breaker_allow (CcLsfClient *self,
+               gboolean    *probe)
+{
+  gboolean allow = TRUE;
+
+  *probe = FALSE;
+  g_mutex_lock (&self->lock);
+  if (self->stuck >= CC_LSF_CLIENT_MAX_STUCK)
+  {
+    self->stats.rejected++;
+    allow = FALSE;
+  }
+  else if (self->failures_in_row >= CC_LSF_CLIENT_BREAKER_THRESHOLD)
+  {
+    if (self->probing || g_get_monotonic_time () < self->open_until)
+    {
+      self->stats.rejected++;
+      allow = FALSE;
+    }
+    else
+    {
+      self->probing = TRUE;
+      *probe = TRUE;
+    }
+  }
+  g_mutex_unlock (&self->lock);
+
+  return allow;
+}
+
+/* A probe that ends without an outcome lets the next call probe, or the
+ * breaker would stay open for good. Called with the lock held. */
+static void
+breaker_release_probe (CcLsfClient *self,
+                       CcLsfCall   *call)
+{
+  if (call->probe && !call->recorded)
+    self->probing = FALSE;
+}
+
+/* Each call counts once: a worker that comes back after its call timed
+ * out has nothing to add, and a late success must not close a breaker
+ * the caller was already told about. */
+static void
+breaker_record (CcLsfClient *self,
+                CcLsfCall   *call,
+                gboolean     success)
+{
+  gboolean reachable;
+  gboolean changed;
+
+  g_mutex_lock (&self->lock);
+  if (call->recorded)
+  {
+    g_mutex_unlock (&self->lock);
+    return;
+  }
+  call->recorded = TRUE;
+  if (call->probe)
+    self->probing = FALSE;
+  if (success)
+    self->failures_in_row = 0;
+  else if (++self->failures_in_row >= CC_LSF_CLIENT_BREAKER_THRESHOLD)
+    self->open_until = g_get_monotonic_time () + self->cooldown * G_TIME_SPAN_MILLISECOND;
+  reachable = self->failures_in_row < CC_LSF_CLIENT_BREAKER_THRESHOLD;
+  changed = (reachable != self->reachable);
+  self->reachable = reachable;
+  g_mutex_unlock (&self->lock);
+
+  if (changed)
+    g_main_context_invoke_full (NULL, G_PRIORITY_DEFAULT,
+                                notify_reachable, g_object_ref (self), g_object_unref);
+}
+
+static gchar *
+client_send (CcLsfClient   *self,
+             CcLsfCall     *call,
+             GError       **error)
+{
+  CcLsfRequest *request = call->request;
+  const char *function = request->function;
+  guint id = call->id;
+  CcLsfJsonMark mark;
+  gchar *symm_key = NULL;
+  gchar *access_token = NULL;
+  gchar *result = NULL;
+  char *response = NULL;
+  guint generation;
+  gint64 trace = cc_lsf_trace_begin ();
+  gint64 start;
+  gint64 sent;
+  int ret = LSF_MESSAGE_SEND_ERROR;
+  int attempt;
+
+  start = g_get_monotonic_time ();
+  cc_lsf_json_mark (request->body, &mark);
+
+  /* A rejected token is renewed and the same request sent again, once.
+   * The token goes last so a retry only rewrites the tail of the body. */
+  for (attempt = 0; attempt < 2; attempt++)
+  {
+    if (!cc_lsf_credentials_get (&symm_key, &access_token, &generation))
+      break;
+
+    cc_lsf_json_rewind (request->body, &mark);
+    cc_lsf_json_add_string (request->body, "access_token", access_token);
+    cc_lsf_json_end_object (request->body);
+    sent = g_get_monotonic_time ();
+    ret = lsf_send_message (symm_key, (char *) cc_lsf_json_get_data (request->body), &response);
+    cc_lsf_metrics_record (function, ret, g_get_monotonic_time () - sent);
+    g_clear_pointer (&symm_key, g_free);
+    g_clear_pointer (&access_token, g_free);
+
+    if (ret != LSF_MESSAGE_RE_AUTH || attempt > 0)
+      break;
+
+    g_clear_pointer (&response, free);
+    g_mutex_lock (&self->lock);
+    self->stats.retries++;
+    g_mutex_unlock (&self->lock);
+    if (!cc_lsf_credentials_refresh (generation))
+      break;
+  }
+
+  if (ret == LSF_MESSAGE_RESP_OK && response)
+    result = g_strdup (response);
+  else if (ret == LSF_MESSAGE_RE_AUTH)
+    g_set_error (error, G_IO_ERROR, G_IO_ERROR_PERMISSION_DENIED,
+                 "LSF request %u (%s) rejected: LSF_MESSAGE_RE_AUTH", id, function);
+  else
+    g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                 "LSF request %u (%s) failed: %d", id, function, ret);
+  g_clear_pointer (&response, free);
+
+  g_mutex_lock (&self->lock);
+  self->stats.last_latency = g_get_monotonic_time () - start;
+  self->latencies[self->latency_next] = self->stats.last_latency;
+  self->latency_next = (self->latency_next + 1) % CC_LSF_CLIENT_LATENCY_SAMPLES;
+  self->latency_count = MIN (self->latency_count + 1, CC_LSF_CLIENT_LATENCY_SAMPLES);
+  if (!result)
+    self->stats.failures++;
+  g_mutex_unlock (&self->lock);
+
+  /* A rejected token says nothing about whether LSF is reachable. */
+  if (ret != LSF_MESSAGE_RE_AUTH)
+    breaker_record (self, call, result != NULL);
+
+  g_debug ("LSF request %u: %s -> %s, %d, %" G_GINT64_FORMAT " us",
+           id, function, request->to, ret, g_get_monotonic_time () - start);
+  cc_lsf_trace_mark (trace, "LSF", "Request", "%u: %s -> %s, %d", id, function, request->to, ret);
+
+  return result;
+}
+
+static guint
+client_begin (CcLsfClient *self)
+{
+  guint in_flight;
+  guint id;
+
+  g_mutex_lock (&self->lock);
+  id = ++self->next_id;
+  self->stats.requests++;
+  in_flight = ++self->stats.in_flight;
+  g_mutex_unlock (&self->lock);
+  cc_lsf_trace_counter (CC_LSF_TRACE_IN_FLIGHT, in_flight);
+
+  return id;
+}
+
+static void
+client_end (CcLsfClient *self)
+{
+  guint in_flight;
+
+  g_mutex_lock (&self->lock);
+  in_flight = --self->stats.in_flight;
+  g_mutex_unlock (&self->lock);
+  cc_lsf_trace_counter (CC_LSF_TRACE_IN_FLIGHT, in_flight);
+}
+
+static void
+lsf_call_thread (GTask        *task,
+                 gpointer      source_object,
+                 gpointer      task_data,
+                 GCancellable *cancellable)
+{
+  CcLsfClient *self = CC_LSF_CLIENT (source_object);
+  CcLsfCall *call = task_data;
+  GError *error = NULL;
+  gchar *result = NULL;
+  gboolean skipped;
+
+  /* Given up on while still queued, there is no one left to answer. */
+  skipped = g_cancellable_set_error_if_cancelled (cancellable, &error);
+  if (!skipped)
+    result = client_send (self, call, &error);
+
+  g_mutex_lock (&self->lock);
+  if (skipped)
+    breaker_release_probe (self, call);
+  call->done = TRUE;
+  if (call->abandoned)
+    self->stuck--;
+  g_mutex_unlock (&self->lock);
+  client_end (self);
+
+  if (result)
+    g_task_return_pointer (task, result, g_free);
+  else
+    g_task_return_error (task, error);
+}
+
+static gboolean
+lsf_call_timeout (gpointer user_data)
+{
+  CcLsfClient *self = CC_LSF_CLIENT (g_task_get_source_object (G_TASK (user_data)));
+  CcLsfCall *call = g_task_get_task_data (G_TASK (user_data));
+
+  call->timed_out = TRUE;
+  g_cancellable_cancel (call->cancellable);
+
+  g_mutex_lock (&self->lock);
+  self->stats.timeouts++;
+  g_mutex_unlock (&self->lock);
+  breaker_record (self, call, FALSE);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+lsf_call_cancelled (GCancellable *cancellable,
+                    gpointer      user_data)
+{
+  g_cancellable_cancel (G_CANCELLABLE (user_data));
+}
+
+/* The task has returned on cancel or timeout; if its worker is still
+ * running it is counted as stuck until lsf_send_message comes back. */
+static void
+lsf_call_abandoned (GCancellable *cancellable,
+                    gpointer      user_data)
+{
+  CcLsfCall *call = user_data;
+  CcLsfClient *self = call->client;
+
+  g_mutex_lock (&self->lock);
+  if (!call->done)
+  {
+    call->abandoned = TRUE;
+    self->stuck++;
+    breaker_release_probe (self, call);
+  }
+  g_mutex_unlock (&self->lock);
+}
+
+void
+cc_lsf_client_call_async (CcLsfClient         *self,
+                          CcLsfRequest        *request,
+                          GCancellable        *cancellable,
+                          GAsyncReadyCallback  callback,
+                          gpointer             user_data)
+{
+  CcLsfCall *call;
+  GTask *task;
+  gboolean probe;
+
+  g_return_if_fail (CC_IS_LSF_CLIENT (self));
+
+  /* GTask would not even start the worker, which is what counts the
+   * call as done, so a call cancelled up front ends here. */
+  if (g_cancellable_is_cancelled (cancellable))
+  {
+    task = g_task_new (self, cancellable, callback, user_data);
+    g_task_set_source_tag (task, cc_lsf_client_call_async);
+    g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_CANCELLED,
+                             "LSF request %s cancelled", request->function);
+    g_object_unref (task);
+    cc_lsf_request_free (request);
+    return;
+  }
+
+  if (!breaker_allow (self, &probe))
+  {
+    task = g_task_new (self, cancellable, callback, user_data);
+    g_task_set_source_tag (task, cc_lsf_client_call_async);
+    g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_HOST_UNREACHABLE,
+                             "LSF unreachable, %s not sent", request->function);
+    g_object_unref (task);
+    cc_lsf_request_free (request);
+    return;
+  }
+
+  call = g_new0 (CcLsfCall, 1);
+  call->client = self;
+  call->probe = probe;
+  call->id = client_begin (self);
+  call->request = request;
+
+  /* The worker cannot interrupt lsf_send_message, so both the caller's
+   * cancellable and the timeout cancel an internal cancellable and the
+   * task returns right away, dropping the late response. */
+  call->cancellable = g_cancellable_new ();
+  g_signal_connect (call->cancellable, "cancelled", G_CALLBACK (lsf_call_abandoned), call);
+  if (cancellable)
+  {
+    call->caller_cancellable = g_object_ref (cancellable);
+    call->cancelled_id = g_cancellable_connect (cancellable,
+                                                G_CALLBACK (lsf_call_cancelled),
+                                                g_object_ref (call->cancellable),
+                                                g_object_unref);
+  }
+
+  task = g_task_new (self, call->cancellable, callback, user_data);
+  g_task_set_source_tag (task, cc_lsf_client_call_async);
+  g_task_set_task_data (task, call, (GDestroyNotify) lsf_call_free);
+  g_task_set_return_on_cancel (task, TRUE);
+
+  call->timeout_source = g_timeout_source_new (request->timeout);
+  g_source_set_callback (call->timeout_source, lsf_call_timeout, g_object_ref (task), g_object_unref);
+  g_source_attach (call->timeout_source, g_main_context_get_thread_default ());
+
+  g_task_run_in_thread (task, lsf_call_thread);
+  g_object_unref (task);
+}
+
+gchar *
+cc_lsf_client_call_finish (CcLsfClient   *self,
+                           GAsyncResult  *result,
+                           GError       **error)
+{
+  CcLsfCall *call;
+  GError *local_error = NULL;
+  gchar *response;
+
+  g_return_val_if_fail (g_task_is_valid (result, self), NULL);
+
+  call = g_task_get_task_data (G_TASK (result));
+  if (call)
+    g_source_destroy (call->timeout_source);
+  response = g_task_propagate_pointer (G_TASK (result), &local_error);
+  if (local_error && call && call->timed_out)
+  {
+    g_clear_error (&local_error);
+    g_set_error (&local_error, G_IO_ERROR, G_IO_ERROR_TIMED_OUT,
+                 "LSF request %u (%s) timed out", call->id, call->request->function);
+  }
+  if (local_error)
+    g_propagate_error (error, local_error);
+
+  return response;
+}
+
+static void
+lsf_call_sync_ready (GObject      *source_object,
+                     GAsyncResult *result,
+                     gpointer      user_data)
+{
+  *((GAsyncResult **) user_data) = g_object_ref (result);
+}
+
+gchar *
+cc_lsf_client_call (CcLsfClient   *self,
+                    CcLsfRequest  *request,
+                    GCancellable  *cancellable,
+                    GError       **error)
+{
+  GMainContext *context;
+  GAsyncResult *result = NULL;
+  gchar *response;
+
+  g_return_val_if_fail (CC_IS_LSF_CLIENT (self), NULL);
+
+  /* Run the async call on a private context so the deadline and the
+   * cancellable apply to synchronous callers as well. */
+  context = g_main_context_new ();
+  g_main_context_push_thread_default (context);
+  cc_lsf_client_call_async (self, request, cancellable, lsf_call_sync_ready, &result);
+  while (result == NULL)
+    g_main_context_iteration (context, TRUE);
+  response = cc_lsf_client_call_finish (self, result, error);
+  g_main_context_pop_thread_default (context);
+
+  g_object_unref (result);
+  g_main_context_unref (context);
+
+  return response;
+}
+
+gboolean
+cc_lsf_client_is_reachable (CcLsfClient *self)
+{
+  gboolean reachable;
+
+  g_return_val_if_fail (CC_IS_LSF_CLIENT (self), FALSE);
+
+  g_mutex_lock (&self->lock);
+  reachable = self->reachable;
+  g_mutex_unlock (&self->lock);
+
+  return reachable;
+}
+
+static int
+compare_latency (const void *a,
+                 const void *b)
+{
+  gint64 x = *(const gint64 *) a;
+  gint64 y = *(const gint64 *) b;
+
+  return (x > y) - (x < y);
+}
+
+void
+cc_lsf_client_get_stats (CcLsfClient      *self,
+                         CcLsfClientStats *stats)
+{
+  gint64 samples[CC_LSF_CLIENT_LATENCY_SAMPLES];
+  guint count;
+
+  g_return_if_fail (CC_IS_LSF_CLIENT (self));
+
+  g_mutex_lock (&self->lock);
+  *stats = self->stats;
+  count = self->latency_count;
+  memcpy (samples, self->latencies, count * sizeof (gint64));
+  g_mutex_unlock (&self->lock);
+
+  if (count > 0)
+  {
+    qsort (samples, count, sizeof (gint64), compare_latency);
+    stats->p50_latency = samples[(count - 1) / 2];
+    stats->p99_latency = samples[(count - 1) * 99 / 100];
+  }
+}
+
+CcLsfClient *
+cc_lsf_client_get_default (void)
+{
+  static gsize initialized = 0;
+  static CcLsfClient *client = NULL;
+
+  if (g_once_init_enter (&initialized))
+  {
+    client = g_object_new (CC_TYPE_LSF_CLIENT, NULL);
+    g_once_init_leave (&initialized, 1);
+  }
+
+  return client;
+}
+
+static void
+cc_lsf_client_finalize (GObject *object)
+{
+  CcLsfClient *self = CC_LSF_CLIENT (object);
+
+  g_mutex_clear (&self->lock);
+
+  G_OBJECT_CLASS (cc_lsf_client_parent_class)->finalize (object);
+}
+
+static void
+cc_lsf_client_set_property (GObject      *object,
+                            guint         prop_id,
+                            const GValue *value,
+                            GParamSpec   *pspec)
+{
+  CcLsfClient *self = CC_LSF_CLIENT (object);
+
+  switch (prop_id)
+  {
+    case PROP_BREAKER_COOLDOWN:
+      g_mutex_lock (&self->lock);
+      self->cooldown = g_value_get_uint (value);
+      g_mutex_unlock (&self->lock);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+cc_lsf_client_get_property (GObject    *object,
+                            guint       prop_id,
+                            GValue     *value,
+                            GParamSpec *pspec)
+{
+  CcLsfClient *self = CC_LSF_CLIENT (object);
+
+  switch (prop_id)
+  {
+    case PROP_REACHABLE:
+      g_value_set_boolean (value, cc_lsf_client_is_reachable (self));
+      break;
+    case PROP_BREAKER_COOLDOWN:
+      g_mutex_lock (&self->lock);
+      g_value_set_uint (value, self->cooldown);
+      g_mutex_unlock (&self->lock);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+cc_lsf_client_class_init (CcLsfClientClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = cc_lsf_client_finalize;
+  object_class->get_property = cc_lsf_client_get_property;
+  object_class->set_property = cc_lsf_client_set_property;
+
+  properties[PROP_REACHABLE] =
+    g_param_spec_boolean ("reachable", NULL, NULL,
+                          TRUE,
+                          G_PARAM_READABLE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS);
+
+  /* How long, in milliseconds, requests fail right away once the
+   * breaker has opened. */
+  properties[PROP_BREAKER_COOLDOWN] =
+    g_param_spec_uint ("breaker-cooldown", NULL, NULL,
+                       0, G_MAXUINT, CC_LSF_CLIENT_BREAKER_COOLDOWN,
+                       G_PARAM_READWRITE | G_PARAM_CONSTRUCT | G_PARAM_STATIC_STRINGS);
+
+  g_object_class_install_properties (object_class, N_PROPS, properties);
+}
+
+static void
+cc_lsf_client_init (CcLsfClient *self)
+{
+  g_mutex_init (&self->lock);
+  self->reachable = TRUE;
+  cc_lsf_metrics_export ();
+}
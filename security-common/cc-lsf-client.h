@@ -0,0 +1,84 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/*
+ * Copyright (C) 2020 gooroom <gooroom@gooroom.kr>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#pragma once
+
+#include <gio/gio.h>
+
+#include "cc-lsf-json.h"
+
+G_BEGIN_DECLS
+
+#define CC_TYPE_LSF_CLIENT (cc_lsf_client_get_type ())
+G_DECLARE_FINAL_TYPE (CcLsfClient, cc_lsf_client, CC, LSF_CLIENT, GObject)
+
+#define CC_LSF_CLIENT_TIMEOUT             10000
+#define CC_LSF_CLIENT_BREAKER_THRESHOLD       3
+#define CC_LSF_CLIENT_BREAKER_COOLDOWN    30000
+#define CC_LSF_CLIENT_MAX_STUCK               2
+#define CC_LSF_CLIENT_POOL                    8
+#define CC_LSF_CLIENT_POOL_BUF            65536
+#define CC_LSF_CLIENT_LATENCY_SAMPLES       256
+
+/* A request owns the JSON body written so far: "to", "from" and
+ * "function" are filled in by cc_lsf_request_new(), the caller appends
+ * its members to the body and the client adds the access token when the
+ * request is sent. */
+typedef struct _CcLsfRequest CcLsfRequest;
+
+typedef struct
+{
+  guint  requests;
+  guint  failures;
+  guint  retries;
+  guint  timeouts;
+  guint  rejected;
+  guint  in_flight;
+  gint64 last_latency;
+  gint64 p50_latency;
+  gint64 p99_latency;
+} CcLsfClientStats;
+
+CcLsfRequest *cc_lsf_request_new         (const char    *to,
+                                          const char    *function);
+CcLsfJson    *cc_lsf_request_get_body    (CcLsfRequest  *request);
+void          cc_lsf_request_set_timeout (CcLsfRequest  *request,
+                                          guint          timeout);
+void          cc_lsf_request_free        (CcLsfRequest  *request);
+
+CcLsfClient *cc_lsf_client_get_default  (void);
+
+gchar       *cc_lsf_client_call         (CcLsfClient          *self,
+                                         CcLsfRequest         *request,
+                                         GCancellable         *cancellable,
+                                         GError              **error);
+void         cc_lsf_client_call_async   (CcLsfClient          *self,
+                                         CcLsfRequest         *request,
+                                         GCancellable         *cancellable,
+                                         GAsyncReadyCallback   callback,
+                                         gpointer              user_data);
+gchar       *cc_lsf_client_call_finish  (CcLsfClient          *self,
+                                         GAsyncResult         *result,
+                                         GError              **error);
+gboolean     cc_lsf_client_is_reachable (CcLsfClient          *self);
+void         cc_lsf_client_get_stats    (CcLsfClient          *self,
+                                         CcLsfClientStats     *stats);
+
+G_END_DECLS
@@ -0,0 +1,192 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/*
+ * Copyright (C) 2020 gooroom <gooroom@gooroom.kr>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <gio/gio.h>
+#include <lsf/lsf-main.h>
+#include <lsf/lsf-util.h>
+#include <lsf/lsf-auth.h>
+#include <lsf/lsf-dbus.h>
+
+#include "cc-lsf-credentials.h"
+
+/* One set of credentials per control center process, shared by every
+ * security panel. The generation is bumped on each successful lsf_auth so
+ * that concurrent callers hitting LSF_MESSAGE_RE_AUTH with the same stale
+ * token only trigger a single re-authentication. */
+static GMutex  credentials_lock;
+static GMutex  auth_lock;
+static gchar  *lsf_symm_key;
+static gchar  *lsf_access_token;
+static guint   lsf_generation;
+static guint   refresh_source;
+static guint   refresh_failures;
+static gboolean prefetching;
+
+static void schedule_refresh (guint seconds);
+
+static gboolean
+authenticate (void)
+{
+  lsf_user_data_t app_data;
+  gchar *old_key;
+  gchar *old_token;
+  guint failures;
+
+  if (lsf_auth (&app_data, CC_LSF_PASSPHRASE) != LSF_AUTH_STAT_OK)
+  {
+    /* Nothing else retries until a request runs into RE_AUTH, so keep
+     * trying in the background, backing off up to the refresh period. */
+    g_debug ("LSF authentication failed");
+    g_mutex_lock (&credentials_lock);
+    refresh_failures = MIN (refresh_failures + 1, 31);
+    failures = refresh_failures;
+    g_mutex_unlock (&credentials_lock);
+    schedule_refresh (MIN ((guint64) CC_LSF_TOKEN_RETRY << (failures - 1),
+                           CC_LSF_TOKEN_REFRESH));
+    return FALSE;
+  }
+
+  g_mutex_lock (&credentials_lock);
+  old_key = lsf_symm_key;
+  old_token = lsf_access_token;
+  lsf_symm_key = g_strdup (app_data.symm_key);
+  lsf_access_token = g_strdup (app_data.access_token);
+  lsf_generation++;
+  refresh_failures = 0;
+  g_mutex_unlock (&credentials_lock);
+
+  g_free (old_key);
+  g_free (old_token);
+
+  schedule_refresh (CC_LSF_TOKEN_REFRESH);
+
+  return TRUE;
+}
+
+static void
+refresh_thread (GTask        *task,
+                gpointer      source_object,
+                gpointer      task_data,
+                GCancellable *cancellable)
+{
+  g_task_return_boolean (task, cc_lsf_credentials_refresh (GPOINTER_TO_UINT (task_data)));
+}
+
+static gboolean
+refresh_timeout (gpointer user_data)
+{
+  GTask *task;
+  guint generation;
+
+  g_mutex_lock (&credentials_lock);
+  refresh_source = 0;
+  generation = lsf_generation;
+  g_mutex_unlock (&credentials_lock);
+
+  task = g_task_new (NULL, NULL, NULL, NULL);
+  g_task_set_task_data (task, GUINT_TO_POINTER (generation), NULL);
+  g_task_run_in_thread (task, refresh_thread);
+  g_object_unref (task);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+schedule_refresh (guint seconds)
+{
+  g_mutex_lock (&credentials_lock);
+  if (refresh_source)
+    g_source_remove (refresh_source);
+  refresh_source = g_timeout_add_seconds (seconds, refresh_timeout, NULL);
+  g_mutex_unlock (&credentials_lock);
+}
+
+gboolean
+cc_lsf_credentials_refresh (guint stale_generation)
+{
+  gboolean ret = TRUE;
+  guint generation;
+
+  g_mutex_lock (&auth_lock);
+  g_mutex_lock (&credentials_lock);
+  generation = lsf_generation;
+  g_mutex_unlock (&credentials_lock);
+  if (generation == stale_generation)
+    ret = authenticate ();
+  g_mutex_unlock (&auth_lock);
+
+  return ret;
+}
+
+gboolean
+cc_lsf_credentials_ensure (void)
+{
+  gboolean ret;
+
+  g_mutex_lock (&credentials_lock);
+  ret = (lsf_access_token != NULL);
+  g_mutex_unlock (&credentials_lock);
+
+  if (!ret)
+    ret = cc_lsf_credentials_refresh (0);
+
+  return ret;
+}
+
+static void
+prefetch_thread (GTask        *task,
+                 gpointer      source_object,
+                 gpointer      task_data,
+                 GCancellable *cancellable)
+{
+  cc_lsf_credentials_ensure ();
+  g_atomic_int_set (&prefetching, FALSE);
+  g_task_return_boolean (task, TRUE);
+}
+
+void
+cc_lsf_credentials_prefetch (void)
+{
+  GTask *task;
+
+  if (!g_atomic_int_compare_and_exchange (&prefetching, FALSE, TRUE))
+    return;
+
+  task = g_task_new (NULL, NULL, NULL, NULL);
+  g_task_run_in_thread (task, prefetch_thread);
+  g_object_unref (task);
+}
+
+gboolean
+cc_lsf_credentials_get (gchar **symm_key,
+                        gchar **access_token,
+                        guint  *generation)
+{
+  if (!cc_lsf_credentials_ensure ())
+    return FALSE;
+
+  g_mutex_lock (&credentials_lock);
+  *symm_key = g_strdup (lsf_symm_key);
+  *access_token = g_strdup (lsf_access_token);
+  *generation = lsf_generation;
+  g_mutex_unlock (&credentials_lock);
+
+  return TRUE;
+}
@@ -0,0 +1,45 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/*
+ * Copyright (C) 2020 gooroom <gooroom@gooroom.kr>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#pragma once
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+#define CC_LSF_DBUS_NAME       "kr.gooroom.controlcenter"
+#define CC_LSF_PASSPHRASE      "n6x6myibEAvfN9vIDDPQi+iCoE7yTuHP//eC195+g7w="
+
+/* LSF does not report the token lifetime, renew it in the background
+ * so requests rarely run into LSF_MESSAGE_RE_AUTH. */
+#define CC_LSF_TOKEN_REFRESH   (20*60)
+
+/* First retry after a failed authentication, in seconds, doubled on
+ * each further failure up to CC_LSF_TOKEN_REFRESH. */
+#define CC_LSF_TOKEN_RETRY     5
+
+gboolean  cc_lsf_credentials_ensure   (void);
+void      cc_lsf_credentials_prefetch (void);
+gboolean  cc_lsf_credentials_get      (gchar **symm_key,
+                                       gchar **access_token,
+                                       guint  *generation);
+gboolean  cc_lsf_credentials_refresh  (guint   stale_generation);
+
+G_END_DECLS
@@ -0,0 +1,259 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/*
+ * Copyright (C) 2020 gooroom <gooroom@gooroom.kr>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "cc-lsf-json.h"
+
+struct _CcLsfJson
+{
+  GString *buf;
+  guint    depth;
+  guint64  commas;  /* bit n set: level n already holds a member */
+};
+
+CcLsfJson *
+cc_lsf_json_new (void)
+{
+  CcLsfJson *json = g_new0 (CcLsfJson, 1);
+
+  json->buf = g_string_sized_new (256);
+
+  return json;
+}
+
+void
+cc_lsf_json_free (CcLsfJson *json)
+{
+  if (json == NULL)
+    return;
+
+  g_string_free (json->buf, TRUE);
+  g_free (json);
+}
+
+void
+cc_lsf_json_reset (CcLsfJson *json)
+{
+  g_string_truncate (json->buf, 0);
+  json->depth = 0;
+  json->commas = 0;
+}
+
+const gchar *
+cc_lsf_json_get_data (CcLsfJson *json)
+{
+  return json->buf->str;
+}
+
+gsize
+cc_lsf_json_get_length (CcLsfJson *json)
+{
+  return json->buf->len;
+}
+
+gsize
+cc_lsf_json_get_capacity (CcLsfJson *json)
+{
+  return json->buf->allocated_len;
+}
+
+/* Escapes a run of valid UTF-8. Besides what JSON requires, U+2028 and
+ * U+2029 are escaped too: they are valid in JSON strings but end a
+ * statement in JavaScript, where replies end up. */
+static void
+quote_valid (GString     *out,
+             const gchar *start,
+             const gchar *end)
+{
+  const guchar *p;
+  const guchar *run;
+
+  /* Copy unescaped runs in one go, only control characters, quotes,
+   * backslashes and the two separators need rewriting. */
+  for (p = run = (const guchar *) start; p < (const guchar *) end; p++)
+  {
+    if (*p >= 0x20 && *p != '"' && *p != '\\' && *p != 0xe2)
+      continue;
+    if (*p == 0xe2 && !(p[1] == 0x80 && (p[2] == 0xa8 || p[2] == 0xa9)))
+      continue;
+
+    g_string_append_len (out, (const gchar *) run, p - run);
+    run = p + 1;
+
+    switch (*p)
+    {
+      case '"':
+        g_string_append (out, "\\\"");
+        break;
+      case '\\':
+        g_string_append (out, "\\\\");
+        break;
+      case '\n':
+        g_string_append (out, "\\n");
+        break;
+      case '\r':
+        g_string_append (out, "\\r");
+        break;
+      case '\t':
+        g_string_append (out, "\\t");
+        break;
+      case '\b':
+        g_string_append (out, "\\b");
+        break;
+      case '\f':
+        g_string_append (out, "\\f");
+        break;
+      case 0xe2:
+        g_string_append (out, p[2] == 0xa8 ? "\\u2028" : "\\u2029");
+        p += 2;
+        run = p + 1;
+        break;
+      default:
+        g_string_append_printf (out, "\\u%04x", *p);
+        break;
+    }
+  }
+  g_string_append_len (out, (const gchar *) run, p - run);
+}
+
+void
+cc_lsf_json_quote (GString     *out,
+                   const gchar *value)
+{
+  const gchar *end;
+
+  g_string_append_c (out, '"');
+
+  /* Each byte of invalid UTF-8 becomes U+FFFD, as with
+   * g_utf8_make_valid(), so the output is always valid JSON. */
+  while (!g_utf8_validate (value, -1, &end))
+  {
+    quote_valid (out, value, end);
+    g_string_append (out, "\\ufffd");
+    value = end + 1;
+  }
+  quote_valid (out, value, end);
+
+  g_string_append_c (out, '"');
+}
+
+static void
+json_member (CcLsfJson   *json,
+             const gchar *key)
+{
+  guint64 bit = G_GUINT64_CONSTANT (1) << json->depth;
+
+  if (json->commas & bit)
+    g_string_append_c (json->buf, ',');
+  json->commas |= bit;
+
+  if (key)
+  {
+    cc_lsf_json_quote (json->buf, key);
+    g_string_append_c (json->buf, ':');
+  }
+}
+
+static void
+json_open (CcLsfJson   *json,
+           const gchar *key,
+           gchar        c)
+{
+  g_return_if_fail (json->depth + 1 < CC_LSF_JSON_MAX_DEPTH);
+
+  json_member (json, key);
+  g_string_append_c (json->buf, c);
+  json->depth++;
+  json->commas &= ~(G_GUINT64_CONSTANT (1) << json->depth);
+}
+
+static void
+json_close (CcLsfJson *json,
+            gchar      c)
+{
+  g_return_if_fail (json->depth > 0);
+
+  json->depth--;
+  g_string_append_c (json->buf, c);
+}
+
+void
+cc_lsf_json_begin_object (CcLsfJson   *json,
+                          const gchar *key)
+{
+  json_open (json, key, '{');
+}
+
+void
+cc_lsf_json_end_object (CcLsfJson *json)
+{
+  json_close (json, '}');
+}
+
+void
+cc_lsf_json_begin_array (CcLsfJson   *json,
+                         const gchar *key)
+{
+  json_open (json, key, '[');
+}
+
+void
+cc_lsf_json_end_array (CcLsfJson *json)
+{
+  json_close (json, ']');
+}
+
+void
+cc_lsf_json_add_string (CcLsfJson   *json,
+                        const gchar *key,
+                        const gchar *value)
+{
+  json_member (json, key);
+  if (value)
+    cc_lsf_json_quote (json->buf, value);
+  else
+    g_string_append (json->buf, "null");
+}
+
+void
+cc_lsf_json_add_raw (CcLsfJson   *json,
+                     const gchar *key,
+                     const gchar *value)
+{
+  json_member (json, key);
+  g_string_append (json->buf, value ? value : "null");
+}
+
+void
+cc_lsf_json_mark (CcLsfJson     *json,
+                  CcLsfJsonMark *mark)
+{
+  mark->len = json->buf->len;
+  mark->depth = json->depth;
+  mark->commas = json->commas;
+}
+
+void
+cc_lsf_json_rewind (CcLsfJson     *json,
+                    CcLsfJsonMark *mark)
+{
+  g_string_truncate (json->buf, mark->len);
+  json->depth = mark->depth;
+  json->commas = mark->commas;
+}
@@ -0,0 +1,69 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/*
+ * Copyright (C) 2020 gooroom <gooroom@gooroom.kr>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#pragma once
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/* Streaming JSON writer over a growable buffer. Keys and string values
+ * are escaped on the way in; the buffer keeps its allocation across
+ * cc_lsf_json_reset() so one writer can serve many requests. */
+typedef struct _CcLsfJson CcLsfJson;
+
+typedef struct
+{
+  gsize   len;
+  guint   depth;
+  guint64 commas;
+} CcLsfJsonMark;
+
+#define CC_LSF_JSON_MAX_DEPTH 64
+
+CcLsfJson   *cc_lsf_json_new          (void);
+void         cc_lsf_json_free         (CcLsfJson     *json);
+void         cc_lsf_json_reset        (CcLsfJson     *json);
+const gchar *cc_lsf_json_get_data     (CcLsfJson     *json);
+gsize        cc_lsf_json_get_length   (CcLsfJson     *json);
+gsize        cc_lsf_json_get_capacity (CcLsfJson     *json);
+
+void         cc_lsf_json_begin_object (CcLsfJson     *json,
+                                       const gchar   *key);
+void         cc_lsf_json_end_object   (CcLsfJson     *json);
+void         cc_lsf_json_begin_array  (CcLsfJson     *json,
+                                       const gchar   *key);
+void         cc_lsf_json_end_array    (CcLsfJson     *json);
+void         cc_lsf_json_add_string   (CcLsfJson     *json,
+                                       const gchar   *key,
+                                       const gchar   *value);
+void         cc_lsf_json_add_raw      (CcLsfJson     *json,
+                                       const gchar   *key,
+                                       const gchar   *value);
+
+void         cc_lsf_json_mark         (CcLsfJson     *json,
+                                       CcLsfJsonMark *mark);
+void         cc_lsf_json_rewind       (CcLsfJson     *json,
+                                       CcLsfJsonMark *mark);
+
+void         cc_lsf_json_quote        (GString       *out,
+                                       const gchar   *value);
+
+G_END_DECLS
@@ -0,0 +1,73 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/*
+ * Copyright (C) 2020 gooroom <gooroom@gooroom.kr>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+
+#include <glib.h>
+
+#include "cc-lsf-log.h"
+
+/* LSF writes one message log per day. */
+gchar *
+cc_lsf_log_get_path (void)
+{
+  GDateTime *local_time;
+  gchar *date;
+  gchar *path;
+
+  local_time = g_date_time_new_now_local ();
+  date = g_date_time_format (local_time, "%F");
+  path = g_strconcat (CC_LSF_LOG_DIRECTORY, CC_LSF_LOG_PREFIX, "-", date, ".log", NULL);
+  g_free (date);
+  g_date_time_unref (local_time);
+
+  return path;
+}
+
+/* Splits "<date> <time> <seq>,<direction>,...,<payload>" into its DMSG
+ * fields. The payload keeps any commas of its own. Returns NULL for lines
+ * that do not carry at least the function field. */
+gchar **
+cc_lsf_log_parse_line (const gchar *line)
+{
+  gchar **columns;
+  gchar **args = NULL;
+
+  columns = g_strsplit (line, " ", 3);
+  if (g_strv_length (columns) == 3)
+  {
+    g_strchomp (columns[2]);
+    args = g_strsplit (columns[2], ",", DMSG_NUM);
+    if (g_strv_length (args) <= DMSG_FUNC)
+      g_clear_pointer (&args, g_strfreev);
+  }
+  g_strfreev (columns);
+
+  return args;
+}
+
+/* The agent announces a new policy to the hub with an "O" message; every
+ * module may have changed its settings after that. */
+gboolean
+cc_lsf_log_is_policy_reload (gchar **args)
+{
+  return !g_strcmp0 (args[DMSG_GLYPH], "O") &&
+         !g_strcmp0 (args[DMSG_FROM], CC_LSF_LOG_AGENT) &&
+         !g_strcmp0 (args[DMSG_TO], CC_LSF_LOG_GHUB);
+}
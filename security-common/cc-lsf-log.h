@@ -0,0 +1,53 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/*
+ * Copyright (C) 2020 gooroom <gooroom@gooroom.kr>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+
+#pragma once
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+#define CC_LSF_LOG_DIRECTORY   "/var/log/lsf/"
+#define CC_LSF_LOG_PREFIX      "message"
+#define CC_LSF_LOG_AGENT       "kr.gooroom.agent"
+#define CC_LSF_LOG_GHUB        "kr.gooroom.ghub"
+
+/* Fields of a message log entry, after the date and time columns. */
+enum
+{
+  DMSG_SEQ,
+  DMSG_DIRECTION,
+  DMSG_METHOD,
+  DMSG_ABS,
+  DMSG_GLYPH,
+  DMSG_FROM,
+  DMSG_TO,
+  DMSG_FUNC,
+  DMSG_ERR,
+  DMSG_PAYLOAD,
+  DMSG_NUM
+};
+
+gchar    *cc_lsf_log_get_path         (void);
+gchar   **cc_lsf_log_parse_line       (const gchar  *line);
+gboolean  cc_lsf_log_is_policy_reload (gchar       **args);
+
+G_END_DECLS
@@ -0,0 +1,201 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/*
+ * Copyright (C) 2020 gooroom <gooroom@gooroom.kr>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+
+
+#include <gio/gio.h>
+#include <lsf/lsf-main.h>
+#include <lsf/lsf-util.h>
+#include <lsf/lsf-auth.h>
+#include <lsf/lsf-dbus.h>
+
+#include "cc-lsf-metrics.h"
+
+enum
+{
+  OUTCOME_OK,
+  OUTCOME_RE_AUTH,
+  OUTCOME_SEND_ERROR,
+  OUTCOME_ERROR,
+  N_OUTCOMES
+};
+
+static const char *outcome_names[N_OUTCOMES] = { "OK", "RE_AUTH", "SEND_ERROR", "ERROR" };
+
+typedef struct
+{
+  guint64 counts[CC_LSF_METRICS_BUCKETS];
+  guint64 sum;
+} Histogram;
+
+static GMutex      lock;
+static GHashTable *histograms;
+
+static const gchar introspection_xml[] =
+  "<node>"
+  "  <interface name='" CC_LSF_METRICS_INTERFACE "'>"
+  "    <method name='GetHistograms'>"
+  "      <arg type='at' name='bounds' direction='out'/>"
+  "      <arg type='a(ssatt)' name='histograms' direction='out'/>"
+  "    </method>"
+  "  </interface>"
+  "</node>";
+
+void
+cc_lsf_metrics_record (const char *function,
+                       int         ret,
+                       gint64      latency)
+{
+  Histogram *histogram;
+  gint64 bound = CC_LSF_METRICS_BUCKET_BASE;
+  int outcome;
+  int i = 0;
+
+  if (ret == LSF_MESSAGE_RESP_OK)
+    outcome = OUTCOME_OK;
+  else if (ret == LSF_MESSAGE_RE_AUTH)
+    outcome = OUTCOME_RE_AUTH;
+  else if (ret == LSF_MESSAGE_SEND_ERROR)
+    outcome = OUTCOME_SEND_ERROR;
+  else
+    outcome = OUTCOME_ERROR;
+
+  while (i < CC_LSF_METRICS_BUCKETS - 1 && latency > bound)
+  {
+    bound <<= 1;
+    i++;
+  }
+
+  g_mutex_lock (&lock);
+  if (!histograms)
+    histograms = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+  histogram = g_hash_table_lookup (histograms, function);
+  if (!histogram)
+  {
+    histogram = g_new0 (Histogram, N_OUTCOMES);
+    g_hash_table_insert (histograms, g_strdup (function), histogram);
+  }
+  histogram[outcome].counts[i]++;
+  histogram[outcome].sum += MAX (latency, 0);
+  g_mutex_unlock (&lock);
+}
+
+static GVariant *
+get_histograms (void)
+{
+  GVariantBuilder bounds;
+  GVariantBuilder rows;
+  GHashTableIter iter;
+  Histogram *histogram;
+  const char *function;
+  int outcome;
+  int i;
+
+  g_variant_builder_init (&bounds, G_VARIANT_TYPE ("at"));
+  for (i = 0; i < CC_LSF_METRICS_BUCKETS - 1; i++)
+    g_variant_builder_add (&bounds, "t", (guint64) CC_LSF_METRICS_BUCKET_BASE << i);
+  g_variant_builder_add (&bounds, "t", G_MAXUINT64);
+
+  g_variant_builder_init (&rows, G_VARIANT_TYPE ("a(ssatt)"));
+  g_mutex_lock (&lock);
+  if (histograms)
+  {
+    g_hash_table_iter_init (&iter, histograms);
+    while (g_hash_table_iter_next (&iter, (gpointer *) &function, (gpointer *) &histogram))
+    {
+      for (outcome = 0; outcome < N_OUTCOMES; outcome++)
+      {
+        GVariant *counts;
+
+        counts = g_variant_new_fixed_array (G_VARIANT_TYPE_UINT64,
+                                            histogram[outcome].counts,
+                                            CC_LSF_METRICS_BUCKETS,
+                                            sizeof (guint64));
+        g_variant_builder_add (&rows, "(ss@att)", function, outcome_names[outcome],
+                               counts, histogram[outcome].sum);
+      }
+    }
+  }
+  g_mutex_unlock (&lock);
+
+  return g_variant_new ("(ata(ssatt))", &bounds, &rows);
+}
+
+static void
+handle_method_call (GDBusConnection       *connection,
+                    const gchar           *sender,
+                    const gchar           *object_path,
+                    const gchar           *interface_name,
+                    const gchar           *method_name,
+                    GVariant              *parameters,
+                    GDBusMethodInvocation *invocation,
+                    gpointer               user_data)
+{
+  if (g_strcmp0 (method_name, "GetHistograms") == 0)
+    g_dbus_method_invocation_return_value (invocation, get_histograms ());
+  else
+    g_dbus_method_invocation_return_error (invocation, G_DBUS_ERROR, G_DBUS_ERROR_UNKNOWN_METHOD,
+                                           "Unknown method %s", method_name);
+}
+
+static const GDBusInterfaceVTable interface_vtable = {
+  handle_method_call,
+  NULL,
+  NULL,
+};
+
+static void
+bus_acquired (GDBusConnection *connection,
+              const gchar     *name,
+              gpointer         user_data)
+{
+  GDBusNodeInfo *info;
+  GError *error = NULL;
+
+  info = g_dbus_node_info_new_for_xml (introspection_xml, NULL);
+  if (!g_dbus_connection_register_object (connection,
+                                          CC_LSF_METRICS_OBJECT_PATH,
+                                          info->interfaces[0],
+                                          &interface_vtable,
+                                          NULL, NULL, &error))
+  {
+    g_warning ("Could not export LSF metrics: %s", error->message);
+    g_error_free (error);
+  }
+  g_dbus_node_info_unref (info);
+}
+
+/* Exported for the lifetime of the process, the histograms outlive any
+ * panel that fed them. */
+void
+cc_lsf_metrics_export (void)
+{
+  static gsize exported = 0;
+
+  if (g_once_init_enter (&exported))
+  {
+    g_bus_own_name (G_BUS_TYPE_SESSION,
+                    CC_LSF_METRICS_BUS_NAME,
+                    G_BUS_NAME_OWNER_FLAGS_NONE,
+                    bus_acquired,
+                    NULL, NULL, NULL, NULL);
+    g_once_init_leave (&exported, 1);
+  }
+}
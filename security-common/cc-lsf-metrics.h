@@ -0,0 +1,44 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/*
+ * Copyright (C) 2020 gooroom <gooroom@gooroom.kr>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+
+
+#pragma once
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/* Round trip times of every LSF send, per function and outcome, in
+ * log-scale buckets. Bucket i counts sends that took at most
+ * CC_LSF_METRICS_BUCKET_BASE << i microseconds, the last one the rest.
+ * They are served on the session bus for the fleet agent to scrape. */
+#define CC_LSF_METRICS_BUS_NAME      "kr.gooroom.controlcenter.Metrics"
+#define CC_LSF_METRICS_OBJECT_PATH   "/kr/gooroom/controlcenter/Metrics"
+#define CC_LSF_METRICS_INTERFACE     "kr.gooroom.controlcenter.Metrics"
+#define CC_LSF_METRICS_BUCKETS       16
+#define CC_LSF_METRICS_BUCKET_BASE   256
+
+void  cc_lsf_metrics_record (const char *function,
+                             int         ret,
+                             gint64      latency);
+void  cc_lsf_metrics_export (void);
+
+G_END_DECLS
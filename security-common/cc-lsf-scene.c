@@ -0,0 +1,233 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/*
+ * Copyright (C) 2020 gooroom <gooroom@gooroom.kr>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cc-lsf-log.h"
+#include "cc-lsf-scene.h"
+#include "cc-lsf-trace.h"
+
+/* Turns the LSF message log into the scenes the framework panel plays.
+ * It has no display of its own, so it can be driven headless, see
+ * tests/bench-lsf-scene.c. */
+struct _CcLsfSceneReader
+{
+  gchar              *path;
+  FILE               *fp;
+  long                offset;
+  gboolean            overlong;
+  gboolean            from_start;
+  CcLsfSceneNameFunc  name_func;
+  gpointer            user_data;
+  CcLsfSceneStats     stats;
+};
+
+static const gchar *cell_dbus_name[CC_LSF_CELL_NUM] = {
+  [CC_LSF_CELL_CC]    = "kr.gooroom.controlcenter",
+  [CC_LSF_CELL_GHUB]  = "kr.gooroom.ghub",
+  [CC_LSF_CELL_GAUTH] = "kr.gooroom.gauth",
+  [CC_LSF_CELL_GCTRL] = "kr.gooroom.gcontroller",
+  [CC_LSF_CELL_AGENT] = "kr.gooroom.agent",
+};
+
+static const gchar *cell_label[CC_LSF_CELL_NUM] = {
+  "CC", "GHUB", "GAUTH", "GCTRL", "AGENT", "GPMS", "APPS"
+};
+
+CcLsfCell
+cc_lsf_scene_get_cell (const gchar *dbus_name)
+{
+  gint i;
+
+  for (i = CC_LSF_CELL_CC; i < CC_LSF_CELL_GPMS; i++)
+  {
+    if (!g_strcmp0 (dbus_name, cell_dbus_name[i]))
+      return i;
+  }
+
+  return CC_LSF_CELL_APPS;
+}
+
+CcLsfSceneReader *
+cc_lsf_scene_reader_new (const gchar        *path,
+                         gboolean            from_start,
+                         CcLsfSceneNameFunc  name_func,
+                         gpointer            user_data)
+{
+  CcLsfSceneReader *reader = g_new0 (CcLsfSceneReader, 1);
+
+  reader->path = g_strdup (path);
+  reader->from_start = from_start;
+  reader->name_func = name_func;
+  reader->user_data = user_data;
+
+  return reader;
+}
+
+void
+cc_lsf_scene_reader_free (CcLsfSceneReader *reader)
+{
+  if (reader == NULL)
+    return;
+
+  if (reader->fp)
+    fclose (reader->fp);
+  g_free (reader->path);
+  g_free (reader);
+}
+
+static const gchar *
+get_name (CcLsfSceneReader *reader,
+          CcLsfCell        *cell,
+          const gchar      *dbus_name)
+{
+  const gchar *name = NULL;
+
+  if (*cell != CC_LSF_CELL_APPS)
+    return cell_label[*cell];
+
+  if (reader->name_func)
+    name = reader->name_func (dbus_name, cell, reader->user_data);
+
+  return name ? name : dbus_name;
+}
+
+static void
+fill_event (CcLsfSceneReader  *reader,
+            gchar            **args,
+            CcLsfSceneEvent   *event)
+{
+  const gchar *from_name;
+  const gchar *to_name;
+
+  event->seq = atoi (args[DMSG_SEQ]);
+  event->from = cc_lsf_scene_get_cell (args[DMSG_FROM]);
+  event->to = cc_lsf_scene_get_cell (args[DMSG_TO]);
+
+  if (cc_lsf_log_is_policy_reload (args))
+    event->scene = CC_LSF_SCENE_POLICY_RELOAD;
+  else if (event->from == CC_LSF_CELL_GHUB)
+    event->scene = CC_LSF_SCENE_METHOD_CALL_REV;
+  else
+    event->scene = CC_LSF_SCENE_METHOD_CALL;
+
+  from_name = get_name (reader, &event->from, args[DMSG_FROM]);
+  to_name = get_name (reader, &event->to, args[DMSG_TO]);
+  event->label = g_strconcat (from_name, "\t-->\t", to_name, "\t",
+                              args[DMSG_GLYPH], " , ", args[DMSG_FUNC], NULL);
+}
+
+/* Reads up to the next message the panel animates. The log is opened on
+ * first use and, unless reading from the start, only what LSF writes
+ * after that is seen. Returns FALSE when there is nothing new yet; a
+ * line still being written is picked up again on the next call. */
+gboolean
+cc_lsf_scene_reader_next (CcLsfSceneReader *reader,
+                          CcLsfSceneEvent  *event)
+{
+  char buf[CC_LSF_SCENE_LINE_MAX];
+  gchar **args;
+  gint64 start;
+  gint64 trace;
+  gsize len;
+
+  if (reader->fp == NULL)
+  {
+    reader->fp = fopen (reader->path, "r");
+    if (reader->fp == NULL)
+      return FALSE;
+    if (!reader->from_start)
+      fseek (reader->fp, 0, SEEK_END);
+    reader->offset = ftell (reader->fp);
+  }
+  else
+    fseek (reader->fp, reader->offset, SEEK_SET);
+
+  while (fgets (buf, sizeof (buf), reader->fp) != NULL)
+  {
+    len = strlen (buf);
+    if (buf[len - 1] != '\n' && len < sizeof (buf) - 1)
+      return FALSE;
+
+    start = g_get_monotonic_time ();
+    trace = cc_lsf_trace_begin ();
+    reader->offset = ftell (reader->fp);
+    reader->stats.bytes += len;
+
+    /* An overlong line is read in buffer-sized pieces, all of which are
+     * dropped: what fit in the first could still parse, cut short. The
+     * line counts as skipped once. */
+    if (reader->overlong || buf[len - 1] != '\n')
+    {
+      if (!reader->overlong)
+      {
+        cc_lsf_trace_mark (trace, "LSF log", "Parse", "skipped");
+        reader->stats.skipped++;
+      }
+      reader->overlong = buf[len - 1] != '\n';
+      reader->stats.parse_time += g_get_monotonic_time () - start;
+      continue;
+    }
+
+    args = cc_lsf_log_parse_line (buf);
+    if (args == NULL)
+    {
+      cc_lsf_trace_mark (trace, "LSF log", "Parse", "skipped");
+      reader->stats.skipped++;
+      reader->stats.parse_time += g_get_monotonic_time () - start;
+      continue;
+    }
+
+    fill_event (reader, args, event);
+    g_strfreev (args);
+
+    cc_lsf_trace_mark (trace, "LSF log", "Parse", "%s", event->label);
+    reader->stats.events++;
+    reader->stats.parse_time += g_get_monotonic_time () - start;
+    return TRUE;
+  }
+
+  return FALSE;
+}
+
+/* Bytes of the log not read yet. */
+goffset
+cc_lsf_scene_reader_get_backlog (CcLsfSceneReader *reader)
+{
+  goffset backlog = 0;
+
+  if (reader->fp)
+  {
+    fseek (reader->fp, 0, SEEK_END);
+    backlog = ftell (reader->fp) - reader->offset;
+    fseek (reader->fp, reader->offset, SEEK_SET);
+  }
+
+  return backlog;
+}
+
+void
+cc_lsf_scene_reader_get_stats (CcLsfSceneReader *reader,
+                               CcLsfSceneStats  *stats)
+{
+  *stats = reader->stats;
+}
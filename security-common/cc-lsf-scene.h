@@ -0,0 +1,94 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/*
+ * Copyright (C) 2020 gooroom <gooroom@gooroom.kr>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/* Longest message log line read in one go; a longer one is skipped. */
+#define CC_LSF_SCENE_LINE_MAX  4096
+
+/* The cells of the framework topology a logged message travels between.
+ * Every module that is not one of the LSF daemons counts as APPS, unless
+ * the name func gives it a cell of its own past CC_LSF_CELL_NUM. */
+typedef enum
+{
+  CC_LSF_CELL_CC,
+  CC_LSF_CELL_GHUB,
+  CC_LSF_CELL_GAUTH,
+  CC_LSF_CELL_GCTRL,
+  CC_LSF_CELL_AGENT,
+  CC_LSF_CELL_GPMS,
+  CC_LSF_CELL_APPS,
+  CC_LSF_CELL_NUM
+} CcLsfCell;
+
+typedef enum
+{
+  CC_LSF_SCENE_IDLE,
+  CC_LSF_SCENE_METHOD_CALL,
+  CC_LSF_SCENE_METHOD_CALL_REV,
+  CC_LSF_SCENE_POLICY_RELOAD,
+  CC_LSF_SCENE_NUM
+} CcLsfScene;
+
+/* One logged message, as the framework panel animates it. The label is
+ * the line shown in the panel's log list and belongs to the caller. */
+typedef struct
+{
+  gint        seq;
+  CcLsfCell   from;
+  CcLsfCell   to;
+  CcLsfScene  scene;
+  gchar      *label;
+} CcLsfSceneEvent;
+
+typedef struct
+{
+  guint64 events;
+  guint64 skipped;
+  guint64 bytes;
+  gint64  parse_time;
+} CcLsfSceneStats;
+
+/* Returns the name to show for a module that is not an LSF daemon, or
+ * NULL to show its D-Bus name. It is called for the sender before the
+ * receiver, and may change the module's cell. */
+typedef const gchar *(*CcLsfSceneNameFunc) (const gchar *dbus_name,
+                                           CcLsfCell   *cell,
+                                           gpointer     user_data);
+
+typedef struct _CcLsfSceneReader CcLsfSceneReader;
+
+CcLsfSceneReader *cc_lsf_scene_reader_new         (const gchar         *path,
+                                                   gboolean             from_start,
+                                                   CcLsfSceneNameFunc   name_func,
+                                                   gpointer             user_data);
+void              cc_lsf_scene_reader_free        (CcLsfSceneReader    *reader);
+gboolean          cc_lsf_scene_reader_next        (CcLsfSceneReader    *reader,
+                                                   CcLsfSceneEvent     *event);
+goffset           cc_lsf_scene_reader_get_backlog (CcLsfSceneReader    *reader);
+void              cc_lsf_scene_reader_get_stats   (CcLsfSceneReader    *reader,
+                                                   CcLsfSceneStats     *stats);
+
+CcLsfCell         cc_lsf_scene_get_cell           (const gchar         *dbus_name);
+
+G_END_DECLS
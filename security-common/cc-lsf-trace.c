@@ -0,0 +1,116 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/*
+ * Copyright (C) 2020 gooroom <gooroom@gooroom.kr>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+
+
+#ifdef HAVE_SYSPROF
+
+#include <string.h>
+#include <sysprof-capture.h>
+
+#include "cc-lsf-trace.h"
+
+static const struct
+{
+  const char *name;
+  const char *description;
+} counters[CC_LSF_TRACE_N_COUNTERS] = {
+  { "In flight", "LSF requests sent and not yet answered" },
+  { "Log backlog", "Bytes of LSF log not yet ingested" },
+  { "Cache hits", "App settings reads answered from the cache" },
+  { "Cache misses", "App settings reads sent to LSF" },
+};
+
+static guint
+get_counter_base (void)
+{
+  static gsize defined = 0;
+  static guint base;
+
+  /* Counter ids are handed out by the collector, so they are defined on
+   * first use rather than at startup. */
+  if (g_once_init_enter (&defined))
+  {
+    SysprofCaptureCounter defs[CC_LSF_TRACE_N_COUNTERS];
+    guint first;
+    int i;
+
+    memset (defs, 0, sizeof (defs));
+    first = sysprof_collector_request_counters (CC_LSF_TRACE_N_COUNTERS);
+    for (i = 0; i < CC_LSF_TRACE_N_COUNTERS; i++)
+    {
+      g_strlcpy (defs[i].category, "LSF", sizeof (defs[i].category));
+      g_strlcpy (defs[i].name, counters[i].name, sizeof (defs[i].name));
+      g_strlcpy (defs[i].description, counters[i].description, sizeof (defs[i].description));
+      defs[i].id = first + i;
+      defs[i].type = SYSPROF_CAPTURE_COUNTER_INT64;
+    }
+    sysprof_collector_define_counters (defs, CC_LSF_TRACE_N_COUNTERS);
+
+    base = first;
+    g_once_init_leave (&defined, 1);
+  }
+
+  return base;
+}
+
+gboolean
+cc_lsf_trace_enabled (void)
+{
+  return sysprof_collector_is_active ();
+}
+
+gint64
+cc_lsf_trace_begin (void)
+{
+  return SYSPROF_CAPTURE_CURRENT_TIME;
+}
+
+void
+cc_lsf_trace_mark (gint64      begin,
+                   const char *group,
+                   const char *name,
+                   const char *format,
+                   ...)
+{
+  va_list args;
+
+  va_start (args, format);
+  sysprof_collector_mark_vprintf (begin, SYSPROF_CAPTURE_CURRENT_TIME - begin,
+                                  group, name, format, args);
+  va_end (args);
+}
+
+void
+cc_lsf_trace_counter (CcLsfTraceCounter counter,
+                      gint64            value)
+{
+  SysprofCaptureCounterValue v;
+  guint id;
+
+  if (!sysprof_collector_is_active ())
+    return;
+
+  id = get_counter_base () + counter;
+  v.v64 = value;
+  sysprof_collector_set_counters (&id, &v, 1);
+}
+
+#endif
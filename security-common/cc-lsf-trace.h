@@ -0,0 +1,61 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/*
+ * Copyright (C) 2020 gooroom <gooroom@gooroom.kr>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+
+#pragma once
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/* Profiler marks and counters, see sysprof(1). They are built only when
+ * sysprof-capture-4 is found at configure time and otherwise compile to
+ * nothing, so call sites need no guards of their own. */
+typedef enum
+{
+  CC_LSF_TRACE_IN_FLIGHT,
+  CC_LSF_TRACE_LOG_BACKLOG,
+  CC_LSF_TRACE_CACHE_HITS,
+  CC_LSF_TRACE_CACHE_MISSES,
+  CC_LSF_TRACE_N_COUNTERS
+} CcLsfTraceCounter;
+
+#ifdef HAVE_SYSPROF
+
+gboolean  cc_lsf_trace_enabled (void);
+gint64    cc_lsf_trace_begin   (void);
+void      cc_lsf_trace_mark    (gint64             begin,
+                                const char        *group,
+                                const char        *name,
+                                const char        *format,
+                                ...) G_GNUC_PRINTF (4, 5);
+void      cc_lsf_trace_counter (CcLsfTraceCounter  counter,
+                                gint64             value);
+
+#else
+
+#define cc_lsf_trace_enabled()                FALSE
+#define cc_lsf_trace_begin()                  ((gint64) 0)
+#define cc_lsf_trace_mark(begin, group, ...)  G_STMT_START { (void) (begin); } G_STMT_END
+#define cc_lsf_trace_counter(counter, value)  G_STMT_START { (void) (value); } G_STMT_END
+
+#endif
+
+G_END_DECLS
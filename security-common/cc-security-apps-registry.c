@@ -0,0 +1,335 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/*
+ * Copyright (C) 2020 gooroom <gooroom@gooroom.kr>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+
+#include <config.h>
+
+#include <unistd.h>
+
+#include "cc-security-apps-registry.h"
+
+/* Keeps the list of installed security-app panels for the whole process.
+ * LSF_CC_PANEL_DIR is walked once; after that the manifest is kept up to
+ * date from file monitors and "app-added" / "app-removed" are emitted as
+ * apps come and go. An app counts as installed once its html/panel.html
+ * exists, which may be some time after its directory shows up, and stops
+ * counting when the file goes away, so that file is watched for every
+ * app directory, installed or not. */
+struct _CcSecurityAppsRegistry
+{
+  GObject       parent_instance;
+
+  GFileMonitor *dir_monitor;
+  GPtrArray    *apps;
+  GHashTable   *watched;
+  guint         rescan_source;
+};
+
+G_DEFINE_TYPE (CcSecurityAppsRegistry, cc_security_apps_registry, G_TYPE_OBJECT)
+
+enum
+{
+  APP_ADDED,
+  APP_REMOVED,
+  N_SIGNALS
+};
+
+static guint signals[N_SIGNALS];
+
+static gchar *
+get_panel_html (const char *dbus_name)
+{
+  return g_build_filename (LSF_CC_PANEL_DIR, dbus_name, "html", "panel.html", NULL);
+}
+
+static gboolean
+find_app (CcSecurityAppsRegistry *self,
+          const char             *dbus_name,
+          guint                  *index)
+{
+  return g_ptr_array_find_with_equal_func (self->apps, dbus_name, g_str_equal, index);
+}
+
+static void schedule_rescan (CcSecurityAppsRegistry *self);
+
+static void
+panel_html_changed (GFileMonitor      *monitor,
+                    GFile             *file,
+                    GFile             *other_file,
+                    GFileMonitorEvent  event_type,
+                    gpointer           user_data)
+{
+  switch (event_type)
+  {
+    case G_FILE_MONITOR_EVENT_CREATED:
+    case G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT:
+    case G_FILE_MONITOR_EVENT_DELETED:
+    case G_FILE_MONITOR_EVENT_MOVED_IN:
+    case G_FILE_MONITOR_EVENT_MOVED_OUT:
+    case G_FILE_MONITOR_EVENT_RENAMED:
+      schedule_rescan (CC_SECURITY_APPS_REGISTRY (user_data));
+      break;
+    default:
+      break;
+  }
+}
+
+static void
+unwatch_panel_html (gpointer data)
+{
+  GFileMonitor *monitor = data;
+
+  g_signal_handlers_disconnect_matched (monitor, G_SIGNAL_MATCH_FUNC,
+                                        0, 0, NULL, panel_html_changed, NULL);
+  g_file_monitor_cancel (monitor);
+  g_object_unref (monitor);
+}
+
+static void
+watch_panel_html (CcSecurityAppsRegistry *self,
+                  const char             *dbus_name)
+{
+  GFileMonitor *monitor;
+  GFile *file;
+  gchar *panel_html;
+
+  if (g_hash_table_contains (self->watched, dbus_name))
+    return;
+
+  panel_html = get_panel_html (dbus_name);
+  file = g_file_new_for_path (panel_html);
+  monitor = g_file_monitor_file (file, G_FILE_MONITOR_WATCH_MOVES, NULL, NULL);
+  if (monitor)
+  {
+    g_signal_connect (monitor, "changed", G_CALLBACK (panel_html_changed), self);
+    g_hash_table_insert (self->watched, g_strdup (dbus_name), monitor);
+  }
+  g_object_unref (file);
+  g_free (panel_html);
+}
+
+static void
+rescan (CcSecurityAppsRegistry *self,
+        gboolean                notify)
+{
+  GHashTable *seen;
+  GHashTable *dirs;
+  GHashTableIter iter;
+  GDir *dir;
+  const gchar *app_dir;
+  gchar *panel_html;
+  gchar *dbus_name;
+  guint i;
+
+  seen = g_hash_table_new (g_str_hash, g_str_equal);
+  dirs = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+  dir = g_dir_open (LSF_CC_PANEL_DIR, 0, NULL);
+  while (dir && (app_dir = g_dir_read_name (dir)) != NULL)
+  {
+    watch_panel_html (self, app_dir);
+    g_hash_table_add (dirs, g_strdup (app_dir));
+
+    panel_html = get_panel_html (app_dir);
+    if (access (panel_html, R_OK))
+    {
+      g_free (panel_html);
+      continue;
+    }
+    g_free (panel_html);
+
+    if (find_app (self, app_dir, &i))
+    {
+      g_hash_table_add (seen, g_ptr_array_index (self->apps, i));
+      continue;
+    }
+
+    dbus_name = g_strdup (app_dir);
+    g_ptr_array_add (self->apps, dbus_name);
+    g_hash_table_add (seen, dbus_name);
+    if (notify)
+      g_signal_emit (self, signals[APP_ADDED], 0, dbus_name);
+  }
+  if (dir)
+    g_dir_close (dir);
+
+  /* Directories deleted since the last scan are no longer watched. */
+  g_hash_table_iter_init (&iter, self->watched);
+  while (g_hash_table_iter_next (&iter, (gpointer *) &dbus_name, NULL))
+  {
+    if (!g_hash_table_contains (dirs, dbus_name))
+      g_hash_table_iter_remove (&iter);
+  }
+  g_hash_table_unref (dirs);
+
+  for (i = self->apps->len; i > 0; i--)
+  {
+    dbus_name = g_ptr_array_index (self->apps, i - 1);
+    if (g_hash_table_contains (seen, dbus_name))
+      continue;
+
+    dbus_name = g_ptr_array_steal_index (self->apps, i - 1);
+    if (notify)
+      g_signal_emit (self, signals[APP_REMOVED], 0, dbus_name);
+    g_free (dbus_name);
+  }
+
+  g_hash_table_unref (seen);
+}
+
+static gboolean
+rescan_timeout (gpointer user_data)
+{
+  CcSecurityAppsRegistry *self = CC_SECURITY_APPS_REGISTRY (user_data);
+
+  self->rescan_source = 0;
+  rescan (self, TRUE);
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Package installs touch many files at once, settle before looking. */
+static void
+schedule_rescan (CcSecurityAppsRegistry *self)
+{
+  if (self->rescan_source)
+    g_source_remove (self->rescan_source);
+  self->rescan_source = g_timeout_add (SECURITY_APPS_RESCAN_DELAY, rescan_timeout, self);
+}
+
+static void
+dir_changed (GFileMonitor      *monitor,
+             GFile             *file,
+             GFile             *other_file,
+             GFileMonitorEvent  event_type,
+             gpointer           user_data)
+{
+  switch (event_type)
+  {
+    case G_FILE_MONITOR_EVENT_CREATED:
+    case G_FILE_MONITOR_EVENT_DELETED:
+    case G_FILE_MONITOR_EVENT_MOVED_IN:
+    case G_FILE_MONITOR_EVENT_MOVED_OUT:
+    case G_FILE_MONITOR_EVENT_RENAMED:
+      schedule_rescan (CC_SECURITY_APPS_REGISTRY (user_data));
+      break;
+    default:
+      break;
+  }
+}
+
+static void
+cc_security_apps_registry_finalize (GObject *object)
+{
+  CcSecurityAppsRegistry *self = CC_SECURITY_APPS_REGISTRY (object);
+
+  if (self->rescan_source)
+    g_source_remove (self->rescan_source);
+  g_clear_object (&self->dir_monitor);
+  g_clear_pointer (&self->watched, g_hash_table_unref);
+  g_clear_pointer (&self->apps, g_ptr_array_unref);
+
+  G_OBJECT_CLASS (cc_security_apps_registry_parent_class)->finalize (object);
+}
+
+static void
+cc_security_apps_registry_class_init (CcSecurityAppsRegistryClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = cc_security_apps_registry_finalize;
+
+  signals[APP_ADDED] = g_signal_new ("app-added",
+                                     G_TYPE_FROM_CLASS (klass),
+                                     G_SIGNAL_RUN_LAST,
+                                     0, NULL, NULL, NULL,
+                                     G_TYPE_NONE, 1, G_TYPE_STRING);
+  signals[APP_REMOVED] = g_signal_new ("app-removed",
+                                       G_TYPE_FROM_CLASS (klass),
+                                       G_SIGNAL_RUN_LAST,
+                                       0, NULL, NULL, NULL,
+                                       G_TYPE_NONE, 1, G_TYPE_STRING);
+}
+
+static void
+cc_security_apps_registry_init (CcSecurityAppsRegistry *self)
+{
+  GFile *dir;
+
+  self->apps = g_ptr_array_new_with_free_func (g_free);
+  self->watched = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, unwatch_panel_html);
+
+  dir = g_file_new_for_path (LSF_CC_PANEL_DIR);
+  self->dir_monitor = g_file_monitor_directory (dir, G_FILE_MONITOR_WATCH_MOVES, NULL, NULL);
+  if (self->dir_monitor)
+    g_signal_connect (self->dir_monitor, "changed", G_CALLBACK (dir_changed), self);
+  g_object_unref (dir);
+
+  rescan (self, FALSE);
+}
+
+CcSecurityAppsRegistry *
+cc_security_apps_registry_get_default (void)
+{
+  static CcSecurityAppsRegistry *registry;
+
+  if (!registry)
+    registry = g_object_new (CC_TYPE_SECURITY_APPS_REGISTRY, NULL);
+
+  return registry;
+}
+
+/* Returns the D-Bus names of the installed apps, in discovery order. */
+GPtrArray *
+cc_security_apps_registry_list_apps (CcSecurityAppsRegistry *self)
+{
+  GPtrArray *apps;
+  guint i;
+
+  g_return_val_if_fail (CC_IS_SECURITY_APPS_REGISTRY (self), NULL);
+
+  apps = g_ptr_array_new_full (self->apps->len, g_free);
+  for (i = 0; i < self->apps->len; i++)
+    g_ptr_array_add (apps, g_strdup (g_ptr_array_index (self->apps, i)));
+
+  return apps;
+}
+
+gboolean
+cc_security_apps_registry_has_app (CcSecurityAppsRegistry *self,
+                                   const char             *dbus_name)
+{
+  g_return_val_if_fail (CC_IS_SECURITY_APPS_REGISTRY (self), FALSE);
+
+  return find_app (self, dbus_name, NULL);
+}
+
+gchar *
+cc_security_apps_registry_get_uri (const char *dbus_name)
+{
+  gchar *panel_html;
+  gchar *uri;
+
+  panel_html = get_panel_html (dbus_name);
+  uri = g_strconcat ("file://", panel_html, NULL);
+  g_free (panel_html);
+
+  return uri;
+}
@@ -0,0 +1,43 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/*
+ * Copyright (C) 2020 gooroom <gooroom@gooroom.kr>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+
+#pragma once
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+/* Every security app installs its panel under LSF_CC_PANEL_DIR/<D-Bus
+ * name>. Changes to it are looked at once they have been quiet for
+ * SECURITY_APPS_RESCAN_DELAY milliseconds. */
+#define LSF_CC_PANEL_DIR            "/var/tmp/lsf/lsf-cc-panel"
+#define SECURITY_APPS_RESCAN_DELAY  500
+
+#define CC_TYPE_SECURITY_APPS_REGISTRY (cc_security_apps_registry_get_type ())
+G_DECLARE_FINAL_TYPE (CcSecurityAppsRegistry, cc_security_apps_registry, CC, SECURITY_APPS_REGISTRY, GObject)
+
+CcSecurityAppsRegistry *cc_security_apps_registry_get_default (void);
+GPtrArray              *cc_security_apps_registry_list_apps   (CcSecurityAppsRegistry *self);
+gboolean                cc_security_apps_registry_has_app     (CcSecurityAppsRegistry *self,
+                                                               const char             *dbus_name);
+gchar                  *cc_security_apps_registry_get_uri     (const char             *dbus_name);
+
+G_END_DECLS
@@ -0,0 +1,300 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/*
+ * Copyright (C) 2020 gooroom <gooroom@gooroom.kr>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <stdlib.h>
+#include <gio/gio.h>
+
+#include "cc-lsf-client.h"
+#include "mock-lsf.h"
+
+#define BENCH_PROBE_INTERVAL  50
+#define BENCH_START_TIMEOUT   5
+
+/* Drives the requests the panels send, in the panels' proportions, through
+ * the shared client against mock-lsf-service on a private bus, and reports
+ * end-to-end latency and how long the main loop was kept from running:
+ *
+ *   bench-lsf-client [OPTION...] PATH-TO-MOCK-LSF-SERVICE */
+
+typedef struct
+{
+  const char *to;
+  const char *function;
+  const char *params;
+} BenchRequest;
+
+/* dbus_message_sender() and modules_state_updater() of the framework panel,
+ * then lsf_msg_handler() of the apps panel. */
+static const BenchRequest mix[] = {
+  { "kr.gooroom.gcontroller", "app_status", "{\"targets\":\"all\"}" },
+  { "kr.gooroom.gcontroller", "app_status", "{\"targets\":\"all\"}" },
+  { "kr.gooroom.gcontroller", "getsettings", "{}" },
+  { "kr.gooroom.gcontroller", "setsettings",
+    "{\"policy\":[{\"dbus_name\":\"kr.gooroom.gcontroller\",\"abs_path\":\"/usr/bin/gcontroller\","
+    "\"settings\":{\"topology_on\":\"true\"}}]}" },
+  { "kr.gooroom.gcontroller", "start", "{\"targets\":\"kr.gooroom.agent\"}" },
+  { "kr.gooroom.gcontroller", "stop", "{\"targets\":\"kr.gooroom.agent\"}" },
+  { "kr.gooroom.mock1", "lsf_get_settings", NULL },
+  { "kr.gooroom.mock1", "lsf_get_settings", NULL },
+  { "kr.gooroom.mock1", "lsf_set_settings", NULL },
+};
+
+static gint requests = 2000;
+static gint concurrency = 8;
+static gint latency;
+static gint jitter;
+static gint errors;
+static gint modules = 4;
+
+static GOptionEntry entries[] = {
+  { "requests", 0, 0, G_OPTION_ARG_INT, &requests, "Number of requests to send", "N" },
+  { "concurrency", 0, 0, G_OPTION_ARG_INT, &concurrency, "Requests kept in flight", "N" },
+  { "latency", 0, 0, G_OPTION_ARG_INT, &latency, "Service reply delay, in ms", "MS" },
+  { "jitter", 0, 0, G_OPTION_ARG_INT, &jitter, "Random delay added on top, in ms", "MS" },
+  { "errors", 0, 0, G_OPTION_ARG_INT, &errors, "Percentage of failed sends", "PERCENT" },
+  { "modules", 0, 0, G_OPTION_ARG_INT, &modules, "Number of modules in app_status", "N" },
+  { NULL }
+};
+
+typedef struct
+{
+  GMainLoop *loop;
+  gint       sent;
+  gint       done;
+  gint       failed;
+  GArray    *latencies;
+  gint64     probe_expected;
+  gint64     max_stall;
+  gint64     total_stall;
+} Bench;
+
+typedef struct
+{
+  Bench  *bench;
+  gint64  start;
+} BenchCall;
+
+static void send_next (Bench *bench);
+
+static void
+request_finished (GObject      *source,
+                  GAsyncResult *result,
+                  gpointer      user_data)
+{
+  BenchCall *call = user_data;
+  Bench *bench = call->bench;
+  GError *error = NULL;
+  gchar *response;
+  gint64 elapsed;
+
+  response = cc_lsf_client_call_finish (CC_LSF_CLIENT (source), result, &error);
+  elapsed = g_get_monotonic_time () - call->start;
+  g_array_append_val (bench->latencies, elapsed);
+  g_free (call);
+  if (!response)
+    bench->failed++;
+  g_clear_error (&error);
+  g_free (response);
+
+  if (++bench->done == requests)
+    g_main_loop_quit (bench->loop);
+  else
+    send_next (bench);
+}
+
+static void
+send_next (Bench *bench)
+{
+  const BenchRequest *mixed;
+  BenchCall *call;
+  CcLsfRequest *request;
+  CcLsfJson *body;
+
+  if (bench->sent == requests)
+    return;
+
+  mixed = &mix[bench->sent++ % G_N_ELEMENTS (mix)];
+  request = cc_lsf_request_new (mixed->to, mixed->function);
+  body = cc_lsf_request_get_body (request);
+  if (mixed->params)
+    cc_lsf_json_add_raw (body, "params", mixed->params);
+  else if (!g_strcmp0 (mixed->function, "lsf_set_settings"))
+    cc_lsf_json_add_raw (body, "app_conf", "{\"enabled\":true,\"level\":3}");
+
+  call = g_new0 (BenchCall, 1);
+  call->bench = bench;
+  call->start = g_get_monotonic_time ();
+  cc_lsf_client_call_async (cc_lsf_client_get_default (), request, NULL,
+                            request_finished, call);
+}
+
+/* Anything past the probe's due time was spent blocked in some other
+ * main loop callback. */
+static gboolean
+stall_probe (gpointer user_data)
+{
+  Bench *bench = user_data;
+  gint64 now = g_get_monotonic_time ();
+  gint64 stall = now - bench->probe_expected;
+
+  if (stall > 0)
+  {
+    bench->total_stall += stall;
+    bench->max_stall = MAX (bench->max_stall, stall);
+  }
+  bench->probe_expected = now + BENCH_PROBE_INTERVAL * G_TIME_SPAN_MILLISECOND;
+
+  return G_SOURCE_CONTINUE;
+}
+
+static void
+service_appeared (GDBusConnection *connection,
+                  const gchar     *name,
+                  const gchar     *name_owner,
+                  gpointer        user_data)
+{
+  g_main_loop_quit (user_data);
+}
+
+static gboolean
+service_timeout (gpointer user_data)
+{
+  g_printerr ("bench-lsf-client: %s did not show up\n", MOCK_LSF_BUS_NAME);
+  exit (1);
+}
+
+/* Starts the mock service on the private bus and waits for its name. */
+static GSubprocess *
+start_service (const char *path,
+               GMainLoop  *loop)
+{
+  GSubprocess *service;
+  GError *error = NULL;
+  gchar *args[6];
+  guint watch;
+  guint timeout;
+  gint i;
+
+  args[0] = (gchar *) path;
+  args[1] = g_strdup_printf ("--latency=%d", latency);
+  args[2] = g_strdup_printf ("--jitter=%d", jitter);
+  args[3] = g_strdup_printf ("--errors=%d", errors);
+  args[4] = g_strdup_printf ("--modules=%d", modules);
+  args[5] = NULL;
+
+  service = g_subprocess_newv ((const gchar * const *) args, G_SUBPROCESS_FLAGS_NONE, &error);
+  for (i = 1; i < 5; i++)
+    g_free (args[i]);
+  if (!service)
+  {
+    g_printerr ("bench-lsf-client: %s\n", error->message);
+    exit (1);
+  }
+
+  watch = g_bus_watch_name (G_BUS_TYPE_SESSION, MOCK_LSF_BUS_NAME, G_BUS_NAME_WATCHER_FLAGS_NONE,
+                            service_appeared, NULL, loop, NULL);
+  timeout = g_timeout_add_seconds (BENCH_START_TIMEOUT, service_timeout, NULL);
+  g_main_loop_run (loop);
+  g_source_remove (timeout);
+  g_bus_unwatch_name (watch);
+
+  return service;
+}
+
+static gint
+compare_latency (gconstpointer a,
+                 gconstpointer b)
+{
+  gint64 x = *(const gint64 *) a;
+  gint64 y = *(const gint64 *) b;
+
+  return (x > y) - (x < y);
+}
+
+int
+main (int argc, char **argv)
+{
+  GOptionContext *context;
+  GTestDBus *bus;
+  GSubprocess *service;
+  CcLsfClientStats stats;
+  GError *error = NULL;
+  Bench bench = { 0 };
+  guint probe;
+  gint64 start;
+  gdouble seconds;
+  gint i;
+
+  context = g_option_context_new ("PATH-TO-MOCK-LSF-SERVICE");
+  g_option_context_add_main_entries (context, entries, NULL);
+  if (!g_option_context_parse (context, &argc, &argv, &error))
+  {
+    g_printerr ("%s\n", error->message);
+    return 1;
+  }
+  if (argc != 2 || requests < 1 || concurrency < 1)
+  {
+    g_printerr ("usage: %s [OPTION...] PATH-TO-MOCK-LSF-SERVICE\n", g_get_prgname ());
+    return 1;
+  }
+  g_option_context_free (context);
+
+  bus = g_test_dbus_new (G_TEST_DBUS_NONE);
+  g_test_dbus_up (bus);
+
+  bench.loop = g_main_loop_new (NULL, FALSE);
+  bench.latencies = g_array_sized_new (FALSE, FALSE, sizeof (gint64), requests);
+  service = start_service (argv[1], bench.loop);
+
+  bench.probe_expected = g_get_monotonic_time () + BENCH_PROBE_INTERVAL * G_TIME_SPAN_MILLISECOND;
+  probe = g_timeout_add (BENCH_PROBE_INTERVAL, stall_probe, &bench);
+
+  start = g_get_monotonic_time ();
+  for (i = 0; i < concurrency; i++)
+    send_next (&bench);
+  g_main_loop_run (bench.loop);
+  seconds = (g_get_monotonic_time () - start) / (gdouble) G_USEC_PER_SEC;
+  g_source_remove (probe);
+
+  g_array_sort (bench.latencies, compare_latency);
+  cc_lsf_client_get_stats (cc_lsf_client_get_default (), &stats);
+
+  g_print ("requests=%d\n", bench.done);
+  g_print ("failures=%d\n", bench.failed);
+  g_print ("retries=%u\n", stats.retries);
+  g_print ("timeouts=%u\n", stats.timeouts);
+  g_print ("rejected=%u\n", stats.rejected);
+  g_print ("requests_per_s=%.0f\n", bench.done / seconds);
+  g_print ("p50_us=%" G_GINT64_FORMAT "\n",
+           g_array_index (bench.latencies, gint64, (bench.latencies->len - 1) / 2));
+  g_print ("p99_us=%" G_GINT64_FORMAT "\n",
+           g_array_index (bench.latencies, gint64, (bench.latencies->len - 1) * 99 / 100));
+  g_print ("stall_max_us=%" G_GINT64_FORMAT "\n", bench.max_stall);
+  g_print ("stall_total_us=%" G_GINT64_FORMAT "\n", bench.total_stall);
+
+  g_subprocess_force_exit (service);
+  g_object_unref (service);
+  g_array_unref (bench.latencies);
+  g_main_loop_unref (bench.loop);
+  g_test_dbus_down (bus);
+  g_object_unref (bus);
+
+  return 0;
+}
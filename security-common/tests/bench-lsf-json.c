@@ -0,0 +1,68 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/*
+ * Copyright (C) 2020 gooroom <gooroom@gooroom.kr>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <glib.h>
+
+#include "cc-lsf-json.h"
+
+#define BENCH_REQUESTS  200000
+#define BENCH_CONF_LEN  4096
+
+/* Builds the request envelope the panels send, with an app_conf that
+ * needs escaping, and reports how fast the writer goes. */
+int
+main (int argc, char **argv)
+{
+  CcLsfJson *json = cc_lsf_json_new ();
+  GString *conf = g_string_new (NULL);
+  guint64 bytes = 0;
+  gint64 start;
+  gdouble seconds;
+  gint i;
+
+  while (conf->len < BENCH_CONF_LEN)
+    g_string_append (conf, "{\"enabled\": true, \"path\": \"C:\\\\tmp\"}\n");
+
+  start = g_get_monotonic_time ();
+  for (i = 0; i < BENCH_REQUESTS; i++)
+  {
+    cc_lsf_json_reset (json);
+    cc_lsf_json_begin_object (json, NULL);
+    cc_lsf_json_add_string (json, "to", "kr.gooroom.ghub");
+    cc_lsf_json_add_string (json, "from", "kr.gooroom.controlcenter");
+    cc_lsf_json_add_string (json, "access_token", "0123456789abcdef");
+    cc_lsf_json_add_string (json, "function", "setsettings");
+    cc_lsf_json_begin_object (json, "params");
+    cc_lsf_json_add_string (json, "app_conf", conf->str);
+    cc_lsf_json_end_object (json);
+    cc_lsf_json_end_object (json);
+    bytes += cc_lsf_json_get_length (json);
+  }
+  seconds = (g_get_monotonic_time () - start) / (gdouble) G_USEC_PER_SEC;
+
+  g_print ("requests_per_s=%.0f\n", BENCH_REQUESTS / seconds);
+  g_print ("mib_per_s=%.1f\n", bytes / seconds / (1024 * 1024));
+  g_print ("buffer_capacity=%" G_GSIZE_FORMAT "\n", cc_lsf_json_get_capacity (json));
+
+  g_string_free (conf, TRUE);
+  cc_lsf_json_free (json);
+
+  return 0;
+}
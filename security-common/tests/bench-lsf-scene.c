@@ -0,0 +1,181 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/*
+ * Copyright (C) 2020 gooroom <gooroom@gooroom.kr>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include "cc-lsf-scene.h"
+
+#define BENCH_EVENTS    200000
+#define BENCH_OVERLONG  10000
+
+/* Feeds a message log through the scene reader as fast as it parses,
+ * without a display, and prints key=value results:
+ *
+ *   bench-lsf-scene [message-YYYY-MM-DD.log]
+ *
+ * Without an argument a synthetic log of BENCH_EVENTS lines is used,
+ * mixing the daemon traffic, app calls and policy reloads of a busy
+ * machine. Every BENCH_OVERLONG-th line is an app call too long for
+ * the reader, which must be skipped whole; the run fails unless every
+ * other line makes an event. */
+
+/* Every allocation in the process is counted, GLib's included, by
+ * interposing the allocator; the real work is left to glibc. */
+extern void *__libc_malloc  (size_t size);
+extern void *__libc_calloc  (size_t nmemb, size_t size);
+extern void *__libc_realloc (void *ptr, size_t size);
+
+static gint allocations;
+
+void *
+malloc (size_t size)
+{
+  g_atomic_int_inc (&allocations);
+  return __libc_malloc (size);
+}
+
+void *
+calloc (size_t nmemb,
+        size_t size)
+{
+  g_atomic_int_inc (&allocations);
+  return __libc_calloc (nmemb, size);
+}
+
+void *
+realloc (void   *ptr,
+         size_t  size)
+{
+  g_atomic_int_inc (&allocations);
+  return __libc_realloc (ptr, size);
+}
+
+static const gchar *lines[] = {
+  "kr.gooroom.controlcenter,kr.gooroom.ghub,app_status",
+  "kr.gooroom.ghub,kr.gooroom.gcontroller,app_status",
+  "kr.gooroom.gcontroller,kr.gooroom.ghub,app_status",
+  "kr.gooroom.ghub,kr.gooroom.controlcenter,app_status",
+  "kr.gooroom.controlcenter,kr.gooroom.ghub,lsf_get_settings",
+  "kr.gooroom.ghub,kr.gooroom.ahnlab.v3,lsf_get_settings",
+  "kr.gooroom.ahnlab.v3,kr.gooroom.ghub,lsf_get_settings",
+  "kr.gooroom.ghub,kr.gooroom.gauth,auth",
+};
+
+static gchar *
+write_synthetic_log (void)
+{
+  GString *log = g_string_new (NULL);
+  GError *error = NULL;
+  gchar *blob;
+  gchar *path;
+  gint fd;
+  gint i;
+
+  blob = g_strnfill (2 * CC_LSF_SCENE_LINE_MAX, 'x');
+  for (i = 0; i < BENCH_EVENTS; i++)
+  {
+    if (i % BENCH_OVERLONG == BENCH_OVERLONG / 2)
+      g_string_append_printf (log, "2020-01-01 00:00:00.000 %d,->,method,abs,M,"
+                              "kr.gooroom.ghub,kr.gooroom.ahnlab.v3,lsf_set_settings,0,"
+                              "{\"params\":{\"blob\":\"%s\"}}\n", i, blob);
+    else if (i % 1000 == 999)
+      g_string_append_printf (log, "2020-01-01 00:00:00.000 %d,->,signal,abs,O,"
+                              "kr.gooroom.agent,kr.gooroom.ghub,reload,0,{}\n", i);
+    else
+      g_string_append_printf (log, "2020-01-01 00:00:00.000 %d,->,method,abs,M,%s,0,"
+                              "{\"params\":{\"targets\":\"all\"}}\n",
+                              i, lines[i % G_N_ELEMENTS (lines)]);
+  }
+
+  fd = g_file_open_tmp ("message-XXXXXX.log", &path, &error);
+  if (fd < 0 || !g_file_set_contents (path, log->str, log->len, &error))
+  {
+    g_printerr ("bench-lsf-scene: %s\n", error->message);
+    exit (1);
+  }
+  close (fd);
+  g_string_free (log, TRUE);
+  g_free (blob);
+
+  return path;
+}
+
+static const gchar *
+get_display_name (const gchar *dbus_name,
+                  CcLsfCell   *cell,
+                  gpointer     user_data)
+{
+  return !strcmp (dbus_name, "kr.gooroom.ahnlab.v3") ? "V3" : NULL;
+}
+
+int
+main (int argc, char **argv)
+{
+  CcLsfSceneReader *reader;
+  CcLsfSceneEvent event;
+  CcLsfSceneStats stats;
+  struct rusage usage;
+  gchar *path;
+  gint64 start;
+  gdouble seconds;
+  gint before;
+  gint status = 0;
+
+  path = argc > 1 ? g_strdup (argv[1]) : write_synthetic_log ();
+  reader = cc_lsf_scene_reader_new (path, TRUE, get_display_name, NULL);
+
+  before = g_atomic_int_get (&allocations);
+  start = g_get_monotonic_time ();
+  while (cc_lsf_scene_reader_next (reader, &event))
+    g_free (event.label);
+  seconds = (g_get_monotonic_time () - start) / (gdouble) G_USEC_PER_SEC;
+
+  cc_lsf_scene_reader_get_stats (reader, &stats);
+  getrusage (RUSAGE_SELF, &usage);
+
+  g_print ("events=%" G_GUINT64_FORMAT "\n", stats.events);
+  g_print ("skipped=%" G_GUINT64_FORMAT "\n", stats.skipped);
+  g_print ("events_per_s=%.0f\n", stats.events / MAX (seconds, 1e-6));
+  g_print ("mib_per_s=%.1f\n", stats.bytes / MAX (seconds, 1e-6) / (1024 * 1024));
+  g_print ("allocations_per_event=%.1f\n",
+           (g_atomic_int_get (&allocations) - before) / (gdouble) MAX (stats.events, 1));
+  g_print ("backlog_bytes=%" G_GOFFSET_FORMAT "\n", cc_lsf_scene_reader_get_backlog (reader));
+  g_print ("peak_rss_kb=%ld\n", usage.ru_maxrss);
+
+  if (argc <= 1 &&
+      (stats.skipped != BENCH_EVENTS / BENCH_OVERLONG ||
+       stats.events != BENCH_EVENTS - BENCH_EVENTS / BENCH_OVERLONG))
+  {
+    g_printerr ("bench-lsf-scene: overlong lines were not skipped whole\n");
+    status = 1;
+  }
+
+  cc_lsf_scene_reader_free (reader);
+  if (argc <= 1)
+    g_unlink (path);
+  g_free (path);
+
+  return status;
+}
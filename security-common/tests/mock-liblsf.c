@@ -0,0 +1,110 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/*
+ * Copyright (C) 2020 gooroom <gooroom@gooroom.kr>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <string.h>
+#include <gio/gio.h>
+#include <lsf/lsf-main.h>
+#include <lsf/lsf-util.h>
+#include <lsf/lsf-auth.h>
+#include <lsf/lsf-dbus.h>
+
+#include "mock-lsf.h"
+
+/* Stands in for liblsf in the client test and benchmarks: both entry
+ * points the control center uses become plain calls to mock-lsf-service,
+ * so a request crosses the session bus the way it does in production. */
+
+static GDBusConnection *
+get_bus (void)
+{
+  static gsize initialized = 0;
+  static GDBusConnection *bus = NULL;
+
+  if (g_once_init_enter (&initialized))
+  {
+    bus = g_bus_get_sync (G_BUS_TYPE_SESSION, NULL, NULL);
+    g_once_init_leave (&initialized, 1);
+  }
+
+  return bus;
+}
+
+/* Fills in a member whether lsf_user_data_t holds it as a pointer or
+ * as a buffer. */
+#define set_user_data(field, value) \
+  _Generic (&(field), \
+            char **: (void) (*(char **) &(field) = strdup (value)), \
+            default: (void) g_strlcpy ((char *) &(field), (value), sizeof (field)))
+
+int
+lsf_auth (lsf_user_data_t *data,
+          char            *passphrase)
+{
+  GVariant *reply;
+  const gchar *symm_key;
+  const gchar *access_token;
+
+  if (!get_bus ())
+    return -1;
+
+  reply = g_dbus_connection_call_sync (get_bus (), MOCK_LSF_BUS_NAME, MOCK_LSF_OBJECT_PATH,
+                                       MOCK_LSF_INTERFACE, "Auth",
+                                       g_variant_new ("(s)", passphrase),
+                                       G_VARIANT_TYPE ("(ss)"), G_DBUS_CALL_FLAGS_NONE,
+                                       -1, NULL, NULL);
+  if (!reply)
+    return -1;
+
+  g_variant_get (reply, "(&s&s)", &symm_key, &access_token);
+  set_user_data (data->symm_key, symm_key);
+  set_user_data (data->access_token, access_token);
+  g_variant_unref (reply);
+
+  return LSF_AUTH_STAT_OK;
+}
+
+/* The response is allocated with malloc, like the one from liblsf. */
+int
+lsf_send_message (char  *symm_key,
+                  char  *message,
+                  char **response)
+{
+  GVariant *reply;
+  const gchar *body;
+  gint32 status;
+
+  if (!get_bus ())
+    return LSF_MESSAGE_SEND_ERROR;
+
+  reply = g_dbus_connection_call_sync (get_bus (), MOCK_LSF_BUS_NAME, MOCK_LSF_OBJECT_PATH,
+                                       MOCK_LSF_INTERFACE, "SendMessage",
+                                       g_variant_new ("(ss)", symm_key, message),
+                                       G_VARIANT_TYPE ("(is)"), G_DBUS_CALL_FLAGS_NONE,
+                                       -1, NULL, NULL);
+  if (!reply)
+    return LSF_MESSAGE_SEND_ERROR;
+
+  g_variant_get (reply, "(i&s)", &status, &body);
+  if (status == LSF_MESSAGE_RESP_OK)
+    *response = strdup (body);
+  g_variant_unref (reply);
+
+  return status;
+}
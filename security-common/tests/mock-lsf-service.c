@@ -0,0 +1,218 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/*
+ * Copyright (C) 2020 gooroom <gooroom@gooroom.kr>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <stdlib.h>
+#include <json-c/json.h>
+#include <gio/gio.h>
+#include <lsf/lsf-main.h>
+#include <lsf/lsf-util.h>
+#include <lsf/lsf-auth.h>
+#include <lsf/lsf-dbus.h>
+
+#include "mock-lsf.h"
+
+/* A local stand-in for the LSF hub and the daemons behind it, so panel
+ * requests can be measured without gcontroller, ghub or gauth. Run it
+ * on a private bus, e.g. under dbus-run-session; the benchmarks start
+ * their own. Latency and jitter are in milliseconds, errors is the
+ * percentage of sends that fail. */
+
+static gint latency;
+static gint jitter;
+static gint errors;
+static gint modules = 4;
+
+static GOptionEntry entries[] = {
+  { "latency", 0, 0, G_OPTION_ARG_INT, &latency, "Delay of every reply, in ms", "MS" },
+  { "jitter", 0, 0, G_OPTION_ARG_INT, &jitter, "Random delay added on top, in ms", "MS" },
+  { "errors", 0, 0, G_OPTION_ARG_INT, &errors, "Percentage of failed sends", "PERCENT" },
+  { "modules", 0, 0, G_OPTION_ARG_INT, &modules, "Number of modules in app_status", "N" },
+  { NULL }
+};
+
+static const gchar introspection_xml[] =
+  "<node>"
+  "  <interface name='" MOCK_LSF_INTERFACE "'>"
+  "    <method name='Auth'>"
+  "      <arg type='s' name='passphrase' direction='in'/>"
+  "      <arg type='s' name='symm_key' direction='out'/>"
+  "      <arg type='s' name='access_token' direction='out'/>"
+  "    </method>"
+  "    <method name='SendMessage'>"
+  "      <arg type='s' name='symm_key' direction='in'/>"
+  "      <arg type='s' name='message' direction='in'/>"
+  "      <arg type='i' name='status' direction='out'/>"
+  "      <arg type='s' name='response' direction='out'/>"
+  "    </method>"
+  "  </interface>"
+  "</node>";
+
+static gchar *
+app_status_response (void)
+{
+  GString *out;
+  gint i;
+
+  out = g_string_new ("{\"return\":{\"result\":[");
+  for (i = 0; i < modules; i++)
+    g_string_append_printf (out,
+                            "%s{\"dbus_name\":\"kr.gooroom.mock%d\","
+                            "\"display_name\":\"Mock %d\","
+                            "\"status\":[{\"exe_stat\":\"%s\",\"auth_stat\":\"auth\"}]}",
+                            i ? "," : "", i, i, i % 3 ? "running" : "stopped");
+  g_string_append (out, "]}}");
+
+  return g_string_free (out, FALSE);
+}
+
+/* Answers with the shapes the panels parse: module status for
+ * app_status, the controller topology for getsettings, an empty app_conf
+ * for lsf_get_settings and a plain result for everything else. */
+static gchar *
+build_response (const gchar *message)
+{
+  struct json_object *msg_obj;
+  struct json_object *func_obj;
+  const gchar *function = NULL;
+  gchar *body;
+
+  msg_obj = json_tokener_parse (message);
+  if (msg_obj && json_object_object_get_ex (msg_obj, "function", &func_obj))
+    function = json_object_get_string (func_obj);
+
+  if (!g_strcmp0 (function, "app_status"))
+    body = app_status_response ();
+  else if (!g_strcmp0 (function, "getsettings"))
+    body = g_strdup ("{\"return\":{\"value\":[{\"dbus_name\":\"kr.gooroom.gcontroller\","
+                     "\"settings\":{\"topology_on\":\"true\"}}]}}");
+  else if (!g_strcmp0 (function, "lsf_get_settings"))
+    body = g_strdup ("{\"return\":{\"app_conf\":{}}}");
+  else
+    body = g_strdup ("{\"return\":{\"result\":\"ok\"}}");
+
+  json_object_put (msg_obj);
+
+  return body;
+}
+
+static gboolean
+send_reply (gpointer user_data)
+{
+  GDBusMethodInvocation *invocation = user_data;
+  GVariant *params = g_dbus_method_invocation_get_parameters (invocation);
+  const gchar *message;
+  gchar *body;
+
+  if (errors && g_random_int_range (0, 100) < errors)
+  {
+    g_dbus_method_invocation_return_value (invocation,
+                                           g_variant_new ("(is)", LSF_MESSAGE_SEND_ERROR, ""));
+    return G_SOURCE_REMOVE;
+  }
+
+  g_variant_get (params, "(&s&s)", NULL, &message);
+  body = build_response (message);
+  g_dbus_method_invocation_return_value (invocation,
+                                         g_variant_new ("(is)", LSF_MESSAGE_RESP_OK, body));
+  g_free (body);
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Replies are delayed on the main loop rather than by blocking, so
+ * concurrent requests overlap as they would against the real daemons. */
+static void
+handle_method_call (GDBusConnection       *connection,
+                    const gchar           *sender,
+                    const gchar           *object_path,
+                    const gchar           *interface_name,
+                    const gchar           *method_name,
+                    GVariant              *parameters,
+                    GDBusMethodInvocation *invocation,
+                    gpointer               user_data)
+{
+  guint delay;
+
+  if (!g_strcmp0 (method_name, "Auth"))
+  {
+    g_dbus_method_invocation_return_value (invocation,
+                                           g_variant_new ("(ss)", "mock-key", "mock-token"));
+    return;
+  }
+
+  delay = latency;
+  if (jitter > 0)
+    delay += g_random_int_range (0, jitter + 1);
+  g_timeout_add (delay, send_reply, invocation);
+}
+
+static const GDBusInterfaceVTable vtable = {
+  handle_method_call,
+  NULL,
+  NULL
+};
+
+static void
+bus_acquired (GDBusConnection *connection,
+              const gchar     *name,
+              gpointer         user_data)
+{
+  GDBusNodeInfo *info = user_data;
+
+  g_dbus_connection_register_object (connection, MOCK_LSF_OBJECT_PATH,
+                                     info->interfaces[0], &vtable,
+                                     NULL, NULL, NULL);
+}
+
+static void
+name_lost (GDBusConnection *connection,
+           const gchar     *name,
+           gpointer         user_data)
+{
+  g_printerr ("mock-lsf-service: could not own %s\n", name);
+  exit (1);
+}
+
+int
+main (int argc, char **argv)
+{
+  GOptionContext *context;
+  GDBusNodeInfo *info;
+  GMainLoop *loop;
+  GError *error = NULL;
+
+  context = g_option_context_new ("- stand-in LSF service");
+  g_option_context_add_main_entries (context, entries, NULL);
+  if (!g_option_context_parse (context, &argc, &argv, &error))
+  {
+    g_printerr ("%s\n", error->message);
+    return 1;
+  }
+  g_option_context_free (context);
+
+  info = g_dbus_node_info_new_for_xml (introspection_xml, NULL);
+  g_bus_own_name (G_BUS_TYPE_SESSION, MOCK_LSF_BUS_NAME, G_BUS_NAME_OWNER_FLAGS_NONE,
+                  bus_acquired, NULL, name_lost, info, NULL);
+
+  loop = g_main_loop_new (NULL, FALSE);
+  g_main_loop_run (loop);
+
+  return 0;
+}
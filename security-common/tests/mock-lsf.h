@@ -0,0 +1,34 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/*
+ * Copyright (C) 2020 gooroom <gooroom@gooroom.kr>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/* The stand-in for the LSF hub used by the client test and benchmarks.
+ * mock-lsf-service owns MOCK_LSF_BUS_NAME on the session bus it is
+ * started on, and the liblsf replacement linked into them sends every
+ * lsf_auth() and lsf_send_message() there. */
+#define MOCK_LSF_BUS_NAME     "kr.gooroom.ghub"
+#define MOCK_LSF_OBJECT_PATH  "/kr/gooroom/ghub"
+#define MOCK_LSF_INTERFACE    "kr.gooroom.ghub.Mock"
+
+G_END_DECLS
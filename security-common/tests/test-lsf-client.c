@@ -0,0 +1,173 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/*
+ * Copyright (C) 2020 gooroom <gooroom@gooroom.kr>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <gio/gio.h>
+
+#include "cc-lsf-client.h"
+#include "mock-lsf.h"
+
+#define TEST_COOLDOWN        50
+#define TEST_START_TIMEOUT    5
+
+/* Runs the shared client against mock-lsf-service on a private bus, with
+ * every send failing so the circuit breaker opens:
+ *
+ *   test-lsf-client PATH-TO-MOCK-LSF-SERVICE */
+
+static const gchar *service_path;
+
+static gchar *
+send_request (GError **error)
+{
+  CcLsfRequest *request = cc_lsf_request_new ("kr.gooroom.gcontroller", "app_status");
+
+  cc_lsf_json_add_raw (cc_lsf_request_get_body (request), "params", "{\"targets\":\"all\"}");
+
+  return cc_lsf_client_call (cc_lsf_client_get_default (), request, NULL, error);
+}
+
+static void
+probe_finished (GObject      *source,
+                GAsyncResult *result,
+                gpointer      user_data)
+{
+  GError **error = user_data;
+
+  g_assert_null (cc_lsf_client_call_finish (CC_LSF_CLIENT (source), result, error));
+}
+
+/* A probe given up on before its worker sent it must not keep the
+ * breaker open. */
+static void
+test_cancelled_probe (void)
+{
+  CcLsfClient *client = cc_lsf_client_get_default ();
+  CcLsfClientStats stats;
+  CcLsfRequest *request;
+  GCancellable *cancellable;
+  GError *error = NULL;
+  gint i;
+
+  g_object_set (client, "breaker-cooldown", TEST_COOLDOWN, NULL);
+
+  for (i = 0; i < CC_LSF_CLIENT_BREAKER_THRESHOLD; i++)
+  {
+    g_assert_null (send_request (&error));
+    g_assert_error (error, G_IO_ERROR, G_IO_ERROR_FAILED);
+    g_clear_error (&error);
+  }
+  g_assert_false (cc_lsf_client_is_reachable (client));
+
+  g_assert_null (send_request (&error));
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_HOST_UNREACHABLE);
+  g_clear_error (&error);
+
+  g_usleep (2 * TEST_COOLDOWN * G_TIME_SPAN_MILLISECOND);
+
+  cancellable = g_cancellable_new ();
+  request = cc_lsf_request_new ("kr.gooroom.gcontroller", "app_status");
+  cc_lsf_client_call_async (client, request, cancellable, probe_finished, &error);
+  g_cancellable_cancel (cancellable);
+  while (error == NULL)
+    g_main_context_iteration (NULL, TRUE);
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+  g_clear_error (&error);
+  g_object_unref (cancellable);
+
+  /* Wait for the worker, whether it skipped the probe or sent it. */
+  do
+  {
+    g_usleep (G_TIME_SPAN_MILLISECOND);
+    cc_lsf_client_get_stats (client, &stats);
+  }
+  while (stats.in_flight > 0);
+
+  g_usleep (2 * TEST_COOLDOWN * G_TIME_SPAN_MILLISECOND);
+
+  g_assert_null (send_request (&error));
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_FAILED);
+  g_clear_error (&error);
+}
+
+static void
+service_appeared (GDBusConnection *connection,
+                  const gchar     *name,
+                  const gchar     *name_owner,
+                  gpointer        user_data)
+{
+  *((gboolean *) user_data) = TRUE;
+}
+
+static GSubprocess *
+start_service (void)
+{
+  GSubprocess *service;
+  GError *error = NULL;
+  gboolean appeared = FALSE;
+  gint64 deadline;
+  guint watch;
+
+  service = g_subprocess_new (G_SUBPROCESS_FLAGS_NONE, &error,
+                              service_path, "--errors=100", NULL);
+  g_assert_no_error (error);
+
+  watch = g_bus_watch_name (G_BUS_TYPE_SESSION, MOCK_LSF_BUS_NAME, G_BUS_NAME_WATCHER_FLAGS_NONE,
+                            service_appeared, NULL, &appeared, NULL);
+  deadline = g_get_monotonic_time () + TEST_START_TIMEOUT * G_USEC_PER_SEC;
+  while (!appeared && g_get_monotonic_time () < deadline)
+  {
+    if (!g_main_context_iteration (NULL, FALSE))
+      g_usleep (G_TIME_SPAN_MILLISECOND);
+  }
+  g_bus_unwatch_name (watch);
+  g_assert_true (appeared);
+
+  return service;
+}
+
+int
+main (int argc, char **argv)
+{
+  GTestDBus *bus;
+  GSubprocess *service;
+  int ret;
+
+  g_test_init (&argc, &argv, NULL);
+  if (argc != 2)
+  {
+    g_printerr ("usage: %s PATH-TO-MOCK-LSF-SERVICE\n", g_get_prgname ());
+    return 1;
+  }
+  service_path = argv[1];
+
+  bus = g_test_dbus_new (G_TEST_DBUS_NONE);
+  g_test_dbus_up (bus);
+  service = start_service ();
+
+  g_test_add_func ("/lsf-client/cancelled-probe", test_cancelled_probe);
+  ret = g_test_run ();
+
+  g_subprocess_force_exit (service);
+  g_object_unref (service);
+  g_test_dbus_down (bus);
+  g_object_unref (bus);
+
+  return ret;
+}
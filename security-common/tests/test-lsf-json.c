@@ -0,0 +1,168 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/*
+ * Copyright (C) 2020 gooroom <gooroom@gooroom.kr>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <json-c/json.h>
+
+#include "cc-lsf-json.h"
+
+#define FUZZ_ROUNDS     20000
+#define FUZZ_MAX_LEN    64
+
+/* Quotes a value, parses it back with json-c and returns what json-c
+ * read, or NULL if it did not parse as a string. */
+static gchar *
+round_trip (const gchar *value)
+{
+  struct json_object *obj;
+  GString *out = g_string_new (NULL);
+  gchar *ret = NULL;
+
+  cc_lsf_json_quote (out, value);
+  obj = json_tokener_parse (out->str);
+  if (obj && json_object_is_type (obj, json_type_string))
+    ret = g_strndup (json_object_get_string (obj), json_object_get_string_len (obj));
+  if (obj)
+    json_object_put (obj);
+  g_string_free (out, TRUE);
+
+  return ret;
+}
+
+static void
+test_quote_escapes (void)
+{
+  const struct
+  {
+    const gchar *value;
+    const gchar *quoted;
+  } cases[] = {
+    { "",                   "\"\"" },
+    { "plain",              "\"plain\"" },
+    { "a\"b",               "\"a\\\"b\"" },
+    { "a\\b",               "\"a\\\\b\"" },
+    { "\n\r\t\b\f",         "\"\\n\\r\\t\\b\\f\"" },
+    { "\x01\x1f",           "\"\\u0001\\u001f\"" },
+    { "\xe2\x80\xa8",       "\"\\u2028\"" },
+    { "\xe2\x80\xa9",       "\"\\u2029\"" },
+    { "\xe2\x82\xac",       "\"\xe2\x82\xac\"" },
+    { "a\xffz",             "\"a\\ufffdz\"" },
+    { "\xc3",               "\"\\ufffd\"" },
+  };
+  GString *out = g_string_new (NULL);
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (cases); i++)
+  {
+    g_string_truncate (out, 0);
+    cc_lsf_json_quote (out, cases[i].value);
+    g_assert_cmpstr (out->str, ==, cases[i].quoted);
+  }
+  g_string_free (out, TRUE);
+}
+
+/* Random bytes, valid UTF-8 or not, must always come back from json-c
+ * as the input with invalid sequences replaced. */
+static void
+test_quote_fuzz (void)
+{
+  gchar value[FUZZ_MAX_LEN + 1];
+  gchar *expected;
+  gchar *parsed;
+  gint len;
+  gint i, j;
+
+  for (i = 0; i < FUZZ_ROUNDS; i++)
+  {
+    len = g_test_rand_int_range (0, FUZZ_MAX_LEN + 1);
+    for (j = 0; j < len; j++)
+    {
+      /* Favour the bytes that need escaping or start a sequence. */
+      switch (g_test_rand_int_range (0, 4))
+      {
+        case 0:
+          value[j] = g_test_rand_int_range (1, 0x20);
+          break;
+        case 1:
+          value[j] = "\"\\\xe2\x80\xa8\xa9"[g_test_rand_int_range (0, 6)];
+          break;
+        default:
+          value[j] = g_test_rand_int_range (1, 0x100);
+          break;
+      }
+    }
+    value[len] = '\0';
+
+    expected = g_utf8_make_valid (value, -1);
+    parsed = round_trip (value);
+    g_assert_nonnull (parsed);
+    g_assert_cmpstr (parsed, ==, expected);
+    g_free (parsed);
+    g_free (expected);
+  }
+}
+
+static void
+test_envelope (void)
+{
+  struct json_object *obj;
+  struct json_object *field;
+  CcLsfJson *json = cc_lsf_json_new ();
+  CcLsfJsonMark mark;
+  GString *conf = g_string_new (NULL);
+
+  /* Larger than any of the old fixed buffers. */
+  while (conf->len < 1024 * 1024)
+    g_string_append (conf, "{\"key\": \"va\\lue\"}\n");
+
+  cc_lsf_json_begin_object (json, NULL);
+  cc_lsf_json_add_string (json, "to", "kr.gooroom.ghub");
+  cc_lsf_json_begin_object (json, "params");
+  cc_lsf_json_add_string (json, "app_conf", conf->str);
+  cc_lsf_json_end_object (json);
+  cc_lsf_json_mark (json, &mark);
+  cc_lsf_json_add_string (json, "access_token", "stale");
+  cc_lsf_json_rewind (json, &mark);
+  cc_lsf_json_add_string (json, "access_token", "fresh");
+  cc_lsf_json_end_object (json);
+
+  obj = json_tokener_parse (cc_lsf_json_get_data (json));
+  g_assert_nonnull (obj);
+  g_assert_true (json_object_object_get_ex (obj, "access_token", &field));
+  g_assert_cmpstr (json_object_get_string (field), ==, "fresh");
+  g_assert_true (json_object_object_get_ex (obj, "params", &field));
+  g_assert_true (json_object_object_get_ex (field, "app_conf", &field));
+  g_assert_cmpstr (json_object_get_string (field), ==, conf->str);
+
+  json_object_put (obj);
+  g_string_free (conf, TRUE);
+  cc_lsf_json_free (json);
+}
+
+int
+main (int argc, char **argv)
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/lsf-json/quote-escapes", test_quote_escapes);
+  g_test_add_func ("/lsf-json/quote-fuzz", test_quote_fuzz);
+  g_test_add_func ("/lsf-json/envelope", test_envelope);
+
+  return g_test_run ();
+}
@@ -20,12 +20,15 @@
 
 #include <config.h>
 #include <math.h>
+#include <string.h>
+#include <unistd.h>
 #include <json-c/json_object.h>
 #include <json-c/json_tokener.h>
 #include <glib/gi18n.h>
 
 #include "cc-security-framework-panel.h"
 #include "cc-security-framework-resources.h"
+#include "cc-security-topology.h"
 
 #define SECURITY_FRAMEWORK_SCHEMA "org.gnome.desktop.security-framework"
 
@@ -34,43 +37,27 @@ struct _CcSecurityFrameworkPanel
   CcPanel    parent_instance;
   GtkWidget *app_button[APPS_MAX];
   GtkWidget *app_menu[APPS_MAX];
-  GtkWidget *ghub_section;
-  GtkWidget *gauth_section;
-  GtkWidget *apps_section;
-  GtkWidget *gpms_button;
-  GtkWidget *gctrl_button;
-  GtkWidget *agent_button;
-  GtkWidget *d1;
-  GtkWidget *d2;
-  GtkWidget *d3;
-  GtkWidget *d4;
-  GtkWidget *d5;
-  GtkWidget *d6;
-  GtkWidget *d7;
-  GtkWidget *d8;
-  GtkWidget *ghub_cc;
-  GtkWidget *ghub_gauth;
-  GtkWidget *ghub_gctrl;
-  GtkWidget *ghub_agent;
-  GtkWidget *ghub_apps;
-  GtkWidget *agent_gpms;
-  GtkWidget *apps_view;
+  GtkWidget *scene_overlay;
+  GtkWidget *topology_area;
+  CcSecurityTopology *graph;
+  gint       active_edge;
   GtkWidget *apps_list;
   GtkWidget *log_label;
   GtkWidget *log_section;
   GtkWidget *gctrl_menu;
   GtkWidget *agent_menu;
-  GtkWidget *cc_image;
-  GtkWidget *ghub_image;
-  GtkWidget *gauth_image;
-  GtkWidget *gctrl_image;
-  GtkWidget *agent_image;
-  GtkWidget *gpms_image;
   GtkWidget *full_log_label;
   GtkWidget *log_window;
   GtkWidget *log_button;
   GtkWidget *security_framework_notebook;
   GtkWidget *no_security_framework_label;
+  GtkWidget *perf_label;
+  guint      perf_source;
+  gint64     perf_reported;
+  guint64    perf_events;
+  gint64     presenter_time;
+  gint64     presenter_max;
+  gint64     updater_time;
   gboolean   animating;
   gboolean   policy_reload_flag;
   gint       policy_reload_seq;
@@ -79,11 +66,9 @@ struct _CcSecurityFrameworkPanel
   gint       init_num;
   guint      event_source_tag[SOURCE_FUNC_NUM];
   gchar     *log_message[LOG_BUF];
-  gchar     *full_log;
+  GString   *full_log;
   gchar     *from_log;
-  gchar     *tailing_file;
-  FILE      *fp;
-  long       fpos;
+  CcLsfSceneReader *log_reader;
   gint       event_cnt;
   gint       scene;
   gint       scene_cnt;
@@ -93,6 +78,14 @@ struct _CcSecurityFrameworkPanel
   gint       from;
   gint       to;
   gint       topology;
+  gboolean   topology_known;
+  gboolean   updating;
+  guint      update_failures;
+  gint       lsf_state;
+  gulong     reachable_handler;
+  GCancellable *cancellable;
+  gint64     init_time;
+  gulong     first_frame_handler;
 };
 
 G_DEFINE_TYPE (CcSecurityFrameworkPanel, cc_security_framework_panel, CC_TYPE_PANEL)
@@ -101,7 +94,6 @@ G_DEFINE_TYPE (CcSecurityFrameworkPanel, cc_security_framework_panel, CC_TYPE_PA
 security_app *apps[APPS_MAX];
 int           selected_app;
 
-static void     do_drawing (GtkWidget *, cairo_t *, gint, gint, gint, gint);
 static gboolean scene_presenter (CcSecurityFrameworkPanel *self);
 static gboolean modules_state_updater (CcSecurityFrameworkPanel *self);
 
@@ -124,7 +116,7 @@ enqueue_log_label (CcSecurityFrameworkPanel *self, char *new_log_message)
   if (new_log_message == NULL)
     return;
 
-  self->full_log = g_strjoin ("\t", self->full_log, new_log_message, "\n", NULL);
+  g_string_append_printf (self->full_log, "\t%s\t\n", new_log_message);
   self->log_end = (self->log_end+1)%LOG_BUF;
 
   if (self->log_cnt == LOG_BUF)
@@ -165,126 +157,36 @@ set_line_color (cairo_t *cr,
   }
 }
 
-static void
-draw_vertical_bar (GtkWidget *widget,
-                   cairo_t   *cr,
-                   gpointer   user_data)
-{
-  double dashed[] = { 3.0 };
-
-  set_line_color (cr, COLOR_BLACK);
-  cairo_set_line_width (cr, 2.0);
-  cairo_set_dash (cr, dashed, 1, 0);
-
-  cairo_move_to (cr, 48, 0);
-  cairo_line_to (cr, 48, 73);
-  cairo_stroke (cr);
-}
-
-static void
-draw_conn_ghub_cc (GtkWidget *widget,
-                   cairo_t   *cr,
-                   gpointer   user_data)
-{
-  CcSecurityFrameworkPanel *self = (CcSecurityFrameworkPanel *) user_data;
-  security_app *cc = find_app (self, CC_DBUS);
-  int color;
-
-  if (cc && cc->auth_stat)
-    color = COLOR_GREEN;
-  else
-    color = COLOR_NONE;
-
-  do_drawing (widget, cr, DIRECTION_GHUB_CC, color, self->scene, self->scene_cnt);
-}
-
-static void
-draw_conn_ghub_gauth (GtkWidget *widget,
-                      cairo_t   *cr,
-                      gpointer   user_data)
-{
-  CcSecurityFrameworkPanel *self = (CcSecurityFrameworkPanel *) user_data;
-  security_app *ghub = find_app (self, GHUB_DBUS);
-  int color;
-
-  if (ghub && ghub->auth_stat)
-    color = COLOR_GREEN;
-  else
-    color = COLOR_NONE;
-
-  do_drawing (widget, cr, DIRECTION_GHUB_GAUTH, color, self->scene, self->scene_cnt);
-}
-
-static void
-draw_conn_ghub_gctrl (GtkWidget *widget,
-                      cairo_t   *cr,
-                      gpointer   user_data)
+/* Connections turn green once the module at either end has been
+ * authenticated, the agent's link to GPMS blue while the agent runs. */
+static gint
+get_edge_color (CcSecurityFrameworkPanel *self,
+                gint                      cell)
 {
-  CcSecurityFrameworkPanel *self = (CcSecurityFrameworkPanel *) user_data;
-  security_app *gctrl = find_app (self, GCTRL_DBUS);
-  int color;
-
-  if (gctrl && gctrl->auth_stat)
-    color = COLOR_GREEN;
-  else
-    color = COLOR_NONE;
-
-  do_drawing (widget, cr, DIRECTION_GHUB_GCTRL, color, self->scene, self->scene_cnt);
-}
-
-static void
-draw_conn_ghub_agent (GtkWidget *widget,
-                       cairo_t   *cr,
-                       gpointer   user_data)
-{
-  CcSecurityFrameworkPanel *self = (CcSecurityFrameworkPanel *) user_data;
-  security_app *agent = find_app (self, AGENT_DBUS);
-  int color;
-
-  if (agent && agent->auth_stat)
-    color = COLOR_GREEN;
-  else
-    color = COLOR_NONE;
-
-  do_drawing (widget, cr, DIRECTION_GHUB_AGENT, color, self->scene, self->scene_cnt);
-}
-
-static void
-draw_conn_ghub_apps (GtkWidget *widget,
-                     cairo_t   *cr,
-                     gpointer   user_data)
-{
-  int color = COLOR_NONE;
+  const gchar *dbus_name;
+  security_app *app;
   int i;
-  CcSecurityFrameworkPanel *self = (CcSecurityFrameworkPanel *) user_data;
 
-  for (i = 0; i < self->apps_num; i++)
+  switch (cell)
   {
-    if (apps[i]->cell_ref == APPS
-        && apps[i]->auth_stat)
-    {
-      color = COLOR_GREEN;
+    case GPMS:
+      app = find_app (self, AGENT_DBUS);
+      return app && app->exe_stat ? COLOR_BLUE : COLOR_NONE;
+    case APPS:
+      for (i = 0; i < self->apps_num; i++)
+        if (apps[i]->cell_ref == APPS && apps[i]->auth_stat)
+          return COLOR_GREEN;
+      return COLOR_NONE;
+    case GAUTH:
+      app = find_app (self, GHUB_DBUS);
+      break;
+    default:
+      dbus_name = cc_security_topology_get_node (self->graph, cell)->dbus_name;
+      app = dbus_name ? find_app (self, dbus_name) : NULL;
       break;
-    }
   }
-  do_drawing (widget, cr, DIRECTION_GHUB_APPS, color, self->scene, self->scene_cnt);
-}
-
-static void
-draw_conn_agent_gpms (GtkWidget *widget,
-                       cairo_t   *cr,
-                       gpointer   user_data)
-{
-  CcSecurityFrameworkPanel *self = (CcSecurityFrameworkPanel *) user_data;
-  security_app *agent = find_app (self, AGENT_DBUS);
-  int color;
-
-  if (agent && agent->exe_stat)
-    color = COLOR_BLUE;
-  else
-    color = COLOR_NONE;
 
-  do_drawing (widget, cr, DIRECTION_AGENT_GPMS, color, self->scene, self->scene_cnt);
+  return app && app->auth_stat ? COLOR_GREEN : COLOR_NONE;
 }
 
 static void
@@ -301,7 +203,7 @@ log_button_clicked (GtkWidget *widget,
   full_log_label = gtk_label_new ("");
   gtk_label_set_xalign (GTK_LABEL (full_log_label), 0);
   gtk_label_set_yalign (GTK_LABEL (full_log_label), 0);
-  gtk_label_set_text (GTK_LABEL (full_log_label), self->full_log);
+  gtk_label_set_text (GTK_LABEL (full_log_label), self->full_log->str);
   gtk_container_add (GTK_CONTAINER (scrolled_window), full_log_label);
   gtk_container_add (GTK_CONTAINER (log_window), scrolled_window);
   gtk_window_set_title (GTK_WINDOW (log_window), _("Panel Log"));
@@ -312,9 +214,8 @@ log_button_clicked (GtkWidget *widget,
 }
 
 static void
-gpms_cell_clicked (GtkWidget      *widget,
-                   GdkEventButton *event,
-                   gpointer        user_data)
+gpms_cell_clicked (GtkButton *button,
+                   gpointer   user_data)
 {
   pid_t pid;
   GKeyFile *key_file;
@@ -326,14 +227,11 @@ gpms_cell_clicked (GtkWidget      *widget,
   if (g_key_file_load_from_file (key_file, GCSR_CONF, G_KEY_FILE_NONE, NULL))
   {
     gpms_uri = g_strconcat ("https://", g_key_file_get_string (key_file, "domain", "gpms", NULL), NULL);
-    if (event->button == GDK_BUTTON_PRIMARY)
+    pid = fork ();
+    if (pid == 0)
     {
-      pid = fork ();
-      if (pid == 0)
-      {
-        execl ("/usr/bin/gooroom-browser", "gooroom-browser", gpms_uri, NULL);
-        exit (EXIT_SUCCESS);
-      }
+      execl ("/usr/bin/gooroom-browser", "gooroom-browser", gpms_uri, NULL);
+      exit (EXIT_SUCCESS);
     }
     if (gpms_uri)
       g_free (gpms_uri);
@@ -380,6 +278,17 @@ agent_cell_clicked (GtkWidget      *widget,
     gtk_menu_popup_at_pointer (GTK_MENU (self->agent_menu), NULL);
 }
 
+/* The keyboard and accessibility way to the menu of a module. */
+static gboolean
+cell_menu_requested (GtkWidget *widget,
+                     gpointer   user_data)
+{
+  gtk_menu_popup_at_widget (GTK_MENU (user_data), widget,
+                            GDK_GRAVITY_SOUTH, GDK_GRAVITY_NORTH, NULL);
+
+  return TRUE;
+}
+
 static void
 app_cell_clicked (GtkWidget      *widget,
                   GdkEventButton *event,
@@ -389,7 +298,7 @@ app_cell_clicked (GtkWidget      *widget,
   {
   }
   else if (event->button == GDK_BUTTON_SECONDARY)
-    gtk_menu_popup_at_pointer (GTK_MENU (apps[GPOINTER_TO_INT (user_data)]->app_menu), NULL);
+    gtk_menu_popup_at_pointer (GTK_MENU (((security_app *) user_data)->app_menu), NULL);
 }
 
 static void
@@ -411,120 +320,100 @@ v3_cell_clicked (GtkWidget      *widget,
     }
   }
   else if (event->button == GDK_BUTTON_SECONDARY)
-    gtk_menu_popup_at_pointer (GTK_MENU (apps[GPOINTER_TO_INT (user_data)]->app_menu), NULL);
+    gtk_menu_popup_at_pointer (GTK_MENU (((security_app *) user_data)->app_menu), NULL);
 }
 
-static gchar *
-dbus_message_sender (gpointer arg_p)
+static void
+set_gctrl_topology (CcLsfJson  *params,
+                    const char *topology_on)
 {
-  int arg = GPOINTER_TO_INT (arg_p);
-  lsf_user_data_t app_data;
-  int ret;
-  int r;
-  char *func = NULL;
-  char param[PARAM_BUF];
-  char *response = NULL;
-  char *req_msg = malloc (DEFAULT_BUF_SIZE);
+  cc_lsf_json_begin_array (params, "policy");
+  cc_lsf_json_begin_object (params, NULL);
+  cc_lsf_json_add_string (params, "dbus_name", GCTRL_DBUS);
+  cc_lsf_json_add_string (params, "abs_path", "/usr/bin/gcontroller");
+  cc_lsf_json_begin_object (params, "settings");
+  cc_lsf_json_add_string (params, "topology_on", topology_on);
+  cc_lsf_json_end_object (params);
+  cc_lsf_json_end_object (params);
+  cc_lsf_json_end_array (params);
+}
 
-  memset (req_msg, 0, DEFAULT_BUF_SIZE);
+static void
+dbus_message_sender (CcSecurityFrameworkPanel *self,
+                     gint                      arg,
+                     GAsyncReadyCallback       callback)
+{
+  static const char *func[NUM_DBUS_ARGS] = { "getsettings",
+                                             "setsettings",
+                                             "setsettings",
+                                             "start",
+                                             "stop",
+                                             "start",
+                                             "stop",
+                                             "app_status" };
+  CcLsfRequest *request;
+  CcLsfJson *params;
+
+  request = cc_lsf_request_new (GCTRL_DBUS, func[arg]);
+  params = cc_lsf_request_get_body (request);
+  cc_lsf_json_begin_object (params, "params");
 
   switch (arg)
   {
     case GET_CONFIG:
-      func = "getsettings";
-      snprintf (param, PARAM_BUF, "");
       break;
     case SET_CONFIG:
-      func = "setsettings";
-      snprintf (param,
-                PARAM_BUF,
-                "\"policy\":[{\
-                 \"dbus_name\": \"%s\",\
-                 \"abs_path\": \"/usr/bin/gcontroller\",\
-                 \"settings\": {\
-                 \"topology_on\": \"true\"}}]",
-                 GCTRL_DBUS);
+      set_gctrl_topology (params, "true");
       break;
     case UNSET_CONFIG:
-      func = "setsettings";
-      snprintf (param,
-                PARAM_BUF,
-                "\"policy\":[{\
-                 \"dbus_name\": \"%s\",\
-                 \"abs_path\": \"/usr/bin/gcontroller\",\
-                 \"settings\": {\
-                 \"topology_on\": \"false\"}}]",
-                 GCTRL_DBUS);
+      set_gctrl_topology (params, "false");
       break;
     case LAUNCH_AGENT:
-      func = "start";
-      snprintf (param,
-                PARAM_BUF,
-                "\"targets\": \"%s\"",
-                AGENT_DBUS);
-      break;
     case KILL_AGENT:
-      func = "stop";
-      snprintf (param,
-                PARAM_BUF,
-                "\"targets\": \"%s\"",
-                AGENT_DBUS);
+      cc_lsf_json_add_string (params, "targets", AGENT_DBUS);
       break;
     case LAUNCH_APP:
-      func = "start";
-      snprintf (param,
-                PARAM_BUF,
-                "\"targets\": \"%s\"",
-                apps[selected_app]->dbus_name);
-      break;
     case KILL_APP:
-      func = "stop";
-      snprintf (param,
-                PARAM_BUF,
-                "\"targets\": \"%s\"",
-                apps[selected_app]->dbus_name);
+      cc_lsf_json_add_string (params, "targets", apps[selected_app]->dbus_name);
       break;
     case GET_STATUS:
-      func = "app_status";
-      snprintf (param,
-                PARAM_BUF,
-                "\"targets\": \"all\"");
+      cc_lsf_json_add_string (params, "targets", "all");
       break;
   }
-  snprintf (req_msg,
-            DEFAULT_BUF_SIZE,
-            "{  \"to\": \"%s\",\
-                \"from\": \"%s\",\
-                \"access_token\": \"%s\",\
-                \"function\": \"%s\",\
-                \"params\": {%s}}",
-            GCTRL_DBUS,
-            CC_DBUS,
-            lsf_panel_access_token,
-            func,
-            param);
-  ret = lsf_send_message (lsf_panel_symm_key, req_msg, &response);
-  free (req_msg);
-  if (ret == LSF_MESSAGE_SEND_ERROR)
+
+  cc_lsf_json_end_object (params);
+  cc_lsf_request_set_timeout (request, LSF_REQUEST_TIMEOUT);
+  cc_lsf_client_call_async (cc_lsf_client_get_default (),
+                            request,
+                            self->cancellable,
+                            callback,
+                            self);
+}
+
+static void
+lsf_command_finished (GObject      *source_object,
+                      GAsyncResult *result,
+                      gpointer      user_data)
+{
+  CcSecurityFrameworkPanel *self;
+  GError *error = NULL;
+  char *ret;
+
+  ret = cc_lsf_client_call_finish (CC_LSF_CLIENT (source_object), result, &error);
+  if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
   {
-    g_print ("LSF_MESSAGE_SEND_ERROR\n");
-    free (response);
-    response = NULL;
+    g_error_free (error);
+    return;
   }
-  if (ret == LSF_MESSAGE_RE_AUTH)
+  if (error)
   {
-    g_print ("LSF_MESSAGE_RE_AUTH\n");
-    r = lsf_auth (&app_data, CC_PASSPHRASE);
-    if (r == LSF_AUTH_STAT_OK)
-    {
-      lsf_panel_symm_key = g_strdup (app_data.symm_key);
-      lsf_panel_access_token = g_strdup (app_data.access_token);
-      dbus_message_sender (GINT_TO_POINTER (GET_CONFIG));
-    }
-    free (response);
-    response = NULL;
+    g_print ("%s\n", error->message);
+    g_error_free (error);
   }
-  return response;
+  g_free (ret);
+
+  self = CC_SECURITY_FRAMEWORK_PANEL (user_data);
+  modules_state_updater (self);
 }
 
 static void
@@ -532,22 +421,15 @@ gctrl_menu_handler (GtkWidget *widget,
                     GdkEvent  *event,
                     gpointer   user_data)
 {
+  CcSecurityFrameworkPanel *self = (CcSecurityFrameworkPanel *) user_data;
   const gchar *selection = gtk_menu_item_get_label (GTK_MENU_ITEM (widget));
-  GThread *thr;
-  char *ret;
 
   if (gtk_check_menu_item_get_active (GTK_CHECK_MENU_ITEM (widget)))
   {
     if (!g_strcmp0 (selection, _("On")))
-    {
-      thr = g_thread_new (NULL, (gpointer) dbus_message_sender, GINT_TO_POINTER (SET_CONFIG));
-      ret = (char *) g_thread_join (thr);
-    }
+      dbus_message_sender (self, SET_CONFIG, lsf_command_finished);
     else if (!g_strcmp0 (selection, _("Off")))
-    {
-      thr = g_thread_new (NULL, (gpointer) dbus_message_sender, GINT_TO_POINTER (UNSET_CONFIG));
-      ret = (char *) g_thread_join (thr);
-    }
+      dbus_message_sender (self, UNSET_CONFIG, lsf_command_finished);
   }
 }
 
@@ -555,53 +437,35 @@ static gboolean
 app_menu_handler (GtkWidget *widget,
                   gpointer   user_data)
 {
+  CcSecurityFrameworkPanel *self = (CcSecurityFrameworkPanel *) user_data;
   const gchar *selection = gtk_menu_item_get_label (GTK_MENU_ITEM (widget));
-  GThread *thr;
-  char *ret;
 
   if (!g_strcmp0 (selection, _("Kill")))
   {
-    selected_app = GPOINTER_TO_INT (user_data);
-    thr = g_thread_new (NULL, (gpointer) dbus_message_sender, GINT_TO_POINTER (KILL_APP));
-    ret = (char *) g_thread_join (thr);
+    selected_app = ((security_app *) g_object_get_data (G_OBJECT (widget), "app"))->app_idx;
+    dbus_message_sender (self, KILL_APP, lsf_command_finished);
   }
   else if (!g_strcmp0 (selection, _("Launch")))
   {
-    selected_app = GPOINTER_TO_INT (user_data);
-    thr = g_thread_new (NULL, (gpointer) dbus_message_sender, GINT_TO_POINTER (LAUNCH_APP));
-    ret = (char *) g_thread_join (thr);
+    selected_app = ((security_app *) g_object_get_data (G_OBJECT (widget), "app"))->app_idx;
+    dbus_message_sender (self, LAUNCH_APP, lsf_command_finished);
   }
 
   return FALSE;
 }
 
-static void
-module_state_update (GtkWidget *widget,
-                     gpointer   user_data)
-{
-  CcSecurityFrameworkPanel *self = (CcSecurityFrameworkPanel*) user_data;
-  modules_state_updater (self);
-}
-
 static gboolean
 agent_menu_handler (GtkWidget *widget,
                      GdkEvent  *event,
                      gpointer   user_data)
 {
+  CcSecurityFrameworkPanel *self = (CcSecurityFrameworkPanel *) user_data;
   const gchar *selection = gtk_menu_item_get_label (GTK_MENU_ITEM (widget));
-  GThread   *thr;
-  char *ret;
 
   if (!g_strcmp0 (selection, _("Kill")))
-  {
-    thr = g_thread_new (NULL, (gpointer) dbus_message_sender, GINT_TO_POINTER (KILL_AGENT));
-    ret = (char *) g_thread_join (thr);
-  }
+    dbus_message_sender (self, KILL_AGENT, lsf_command_finished);
   else if (!g_strcmp0 (selection, _("Launch")))
-  {
-    thr = g_thread_new (NULL, (gpointer) dbus_message_sender, GINT_TO_POINTER (LAUNCH_AGENT));
-    ret = (char *) g_thread_join (thr);
-  }
+    dbus_message_sender (self, LAUNCH_AGENT, lsf_command_finished);
 
   return FALSE;
 }
@@ -613,7 +477,8 @@ set_menu_items (CcSecurityFrameworkPanel *self,
   GtkWidget *menu;
   GtkWidget *sub_menu;
   GtkWidget *menu_item;
-  GtkRadioMenuItem *last_item = NULL;
+  GtkWidget *on_item;
+  GtkWidget *off_item;
   GSList *conf_group = NULL;
 
   if (module == GCTRL)
@@ -621,26 +486,28 @@ set_menu_items (CcSecurityFrameworkPanel *self,
     menu = self->gctrl_menu;
     menu_item = gtk_menu_item_new_with_label (_("Configuration Management"));
     gtk_menu_attach (GTK_MENU (menu), menu_item, 0, 1, 0, 1);
+    /* Without the current configuration there is no state to show, and
+     * nothing the user picks could be told apart from a change. */
+    gtk_widget_set_sensitive (menu_item, self->topology_known);
     sub_menu = gtk_menu_new ();
     gtk_menu_item_set_submenu (GTK_MENU_ITEM (menu_item), sub_menu);
-    menu_item = gtk_radio_menu_item_new_with_label (conf_group, _("On"));
-    if (self->topology)
-      gtk_check_menu_item_set_active (GTK_CHECK_MENU_ITEM (menu_item), TRUE);
-    g_signal_connect (G_OBJECT (menu_item),
+    on_item = gtk_radio_menu_item_new_with_label (conf_group, _("On"));
+    gtk_menu_attach (GTK_MENU (sub_menu), on_item, 0, 1, 0, 1);
+    conf_group = gtk_radio_menu_item_get_group (GTK_RADIO_MENU_ITEM (on_item));
+    off_item = gtk_radio_menu_item_new_with_label (conf_group, _("Off"));
+    gtk_menu_attach (GTK_MENU (sub_menu), off_item, 0, 1, 1, 2);
+
+    /* The initial state is set before the handlers are connected, so
+     * showing it never sends a SET_CONFIG or UNSET_CONFIG. */
+    gtk_check_menu_item_set_active (GTK_CHECK_MENU_ITEM (self->topology ? on_item : off_item), TRUE);
+    g_signal_connect (G_OBJECT (on_item),
                       "toggled",
                       G_CALLBACK (gctrl_menu_handler),
                       self);
-    gtk_menu_attach (GTK_MENU (sub_menu), menu_item, 0, 1, 0, 1);
-    conf_group = gtk_radio_menu_item_get_group (GTK_RADIO_MENU_ITEM (menu_item));
-    gtk_check_menu_item_set_active (GTK_CHECK_MENU_ITEM (menu_item), TRUE);
-    menu_item = gtk_radio_menu_item_new_with_label (conf_group, _("Off"));
-    if (!self->topology)
-      gtk_check_menu_item_set_active (GTK_CHECK_MENU_ITEM (menu_item), TRUE);
-    g_signal_connect (G_OBJECT (menu_item),
+    g_signal_connect (G_OBJECT (off_item),
                       "toggled",
                       G_CALLBACK (gctrl_menu_handler),
                       self);
-    gtk_menu_attach (GTK_MENU (sub_menu), menu_item, 0, 1, 1, 2);
     gtk_widget_show_all (menu);
   }
   else if (module == AGENT)
@@ -651,34 +518,79 @@ set_menu_items (CcSecurityFrameworkPanel *self,
     g_signal_connect (G_OBJECT (menu_item),
                       "activate",
                       G_CALLBACK (agent_menu_handler),
-                      NULL);
-    g_signal_connect_after (G_OBJECT (menu_item),
-                            "activate",
-                            G_CALLBACK (module_state_update),
-                            self);
+                      self);
     menu_item = gtk_menu_item_new_with_label (_("Kill"));
     gtk_menu_attach (GTK_MENU (menu), menu_item, 0, 1, 1, 2);
     g_signal_connect (G_OBJECT (menu_item),
                       "activate",
                       G_CALLBACK (agent_menu_handler),
-                      NULL);
-    g_signal_connect_after (G_OBJECT (menu_item),
-                            "activate",
-                            G_CALLBACK (module_state_update),
-                            self);
+                      self);
     gtk_widget_show_all (menu);
   }
 }
 
+/* Repaints what changed since the last call, in one pass. */
+static void
+draw_lines (CcSecurityFrameworkPanel *self)
+{
+  cairo_region_t *damage = cc_security_topology_take_damage (self->graph);
+
+  if (!damage)
+    return;
+
+  gtk_widget_queue_draw_region (self->topology_area, damage);
+  cairo_region_destroy (damage);
+}
+
+/* Node and app button state is only written when it changes, and only
+ * what changed is repainted by draw_lines(). */
+static void
+set_node_opacity (CcSecurityFrameworkPanel *self,
+                  gint                      cell,
+                  gdouble                   opacity)
+{
+  CcTopologyNode *node = cc_security_topology_get_node (self->graph, cell);
+
+  if (node->opacity != opacity)
+  {
+    node->opacity = opacity;
+    cc_security_topology_damage_node (self->graph, cell);
+  }
+}
+
+static void
+set_node_color (CcSecurityFrameworkPanel *self,
+                gint                      cell,
+                gint                      color)
+{
+  CcTopologyNode *node = cc_security_topology_get_node (self->graph, cell);
+
+  if (node->color != color)
+  {
+    node->color = color;
+    cc_security_topology_damage_edge (self->graph, cell);
+  }
+}
+
+static void
+set_button_opacity (security_app *app,
+                    gdouble       opacity)
+{
+  if (app->opacity != opacity)
+  {
+    app->opacity = opacity;
+    gtk_widget_set_opacity (app->app_button, opacity);
+  }
+}
+
 static void
 set_modules_opacity (CcSecurityFrameworkPanel *self)
 {
   int i;
-  security_app *app = NULL;
 
   if (self->apps_num > 0)
   {
-    gtk_widget_set_opacity (self->apps_section, 1.0);
+    set_node_opacity (self, APPS, 1.0);
     for (i = 0; i < self->apps_num; i++)
     {
       switch (apps[i]->cell_ref)
@@ -686,566 +598,586 @@ set_modules_opacity (CcSecurityFrameworkPanel *self)
         case CC:
           break;
         case GHUB:
-          if (apps[i]->exe_stat)
-            gtk_widget_set_opacity (self->ghub_section, 1.0);
-          else
-            gtk_widget_set_opacity (self->ghub_section, 0.3);
-          break;
         case GAUTH:
-          if (apps[i]->exe_stat)
-            gtk_widget_set_opacity (self->gauth_section, 1.0);
-          else
-            gtk_widget_set_opacity (self->gauth_section, 0.3);
-          break;
         case GCTRL:
-          if (apps[i]->exe_stat)
-            gtk_widget_set_opacity (self->gctrl_button, 1.0);
-          else
-            gtk_widget_set_opacity (self->gctrl_button, 0.3);
-          break;
         case AGENT:
-          if (apps[i]->exe_stat)
-            gtk_widget_set_opacity (self->agent_button, 1.0);
-          else
-            gtk_widget_set_opacity (self->agent_button, 0.3);
+        default:
+          set_node_opacity (self, apps[i]->cell_ref, apps[i]->exe_stat ? 1.0 : 0.3);
           break;
         case APPS:
-          if (apps[i]->exe_stat)
-            gtk_widget_set_opacity (apps[i]->app_button, 1.0);
-          else
-            gtk_widget_set_opacity (apps[i]->app_button, 0.3);
+          set_button_opacity (apps[i], apps[i]->exe_stat ? 1.0 : 0.3);
           break;
       }
     }
   }
   else
   {
-    gtk_widget_set_opacity (self->ghub_section, 0.3);
-    gtk_widget_set_opacity (self->gauth_section, 0.3);
-    gtk_widget_set_opacity (self->gctrl_button, 0.3);
-    gtk_widget_set_opacity (self->agent_button, 0.3);
-    gtk_widget_set_opacity (self->apps_section, 0.3);
+    for (i = GHUB; i < (int) cc_security_topology_get_n_nodes (self->graph); i++)
+      if (i != GPMS)
+        set_node_opacity (self, i, 0.3);
   }
+
+  for (i = 0; i < (int) cc_security_topology_get_n_nodes (self->graph); i++)
+    if (cc_security_topology_get_node (self->graph, i)->parent >= 0)
+      set_node_color (self, i, get_edge_color (self, i));
+
+  draw_lines (self);
 }
 
-static void
-draw_lines (CcSecurityFrameworkPanel *self)
+/* From which tick the dots run along a scene's connection, and in
+ * which direction they travel. */
+static const struct
 {
-  gtk_widget_queue_draw (self->d1);
-  gtk_widget_queue_draw (self->d2);
-  gtk_widget_queue_draw (self->d3);
-  gtk_widget_queue_draw (self->d4);
-  gtk_widget_queue_draw (self->d5);
-  gtk_widget_queue_draw (self->d6);
-  gtk_widget_queue_draw (self->d7);
-  gtk_widget_queue_draw (self->d8);
-}
+  gint start;
+  gint reverse;
+} edge_motion[SCENE_NUM] = {
+  [SCENE_METHOD_CALL]     = { STARTING_BLINK_CNT, NORM },
+  [SCENE_METHOD_CALL_REV] = { STARTING_BLINK_CNT, REV },
+  [SCENE_POLICY_RELOAD]   = { STARTING_BLINK_CNT, NORM },
+};
 
 static void
-do_drawing (GtkWidget *widget,
-            cairo_t   *cr,
-            gint       direction,
-            gint       color,
-            gint       scene,
-            gint       scene_cnt)
+do_drawing (cairo_t        *cr,
+            CcTopologyNode *node,
+            gint            cell,
+            gboolean        moving,
+            gint            scene,
+            gint            scene_cnt)
 {
   int i;
-  int reverse = NORM;
-  gboolean color_scope = FALSE;
-  gboolean vert_bar = FALSE;
-  int right_xpos = 78;
-  int mid_xpos = 46;
-  int left_xpos = 18;
-  int up_ypos = 12;
-  int mid_ypos = 35;
-  int down_ypos = 60;
-  double dashed[] = { 3.0 };
-  int ht = HT;
-  int vt = VT;
-  int xpos;
-  int ypos;
+  int reverse = edge_motion[scene].reverse;
+  int start = edge_motion[scene].start;
+  gint color = node->color;
+  gboolean color_scope;
+  double xpos = node->dot_x;
+  double ypos = node->dot_y;
+  gint64 trace = cc_lsf_trace_begin ();
 
-  cairo_set_line_width (cr, 2.0);
-  set_line_color (cr, color);
-
-  switch (scene)
-  {
-    case SCENE_METHOD_CALL:
-      if (STARTING_BLINK_CNT < scene_cnt
-          && scene_cnt < STARTING_BLINK_CNT+MOVING_CNT)
-        color_scope = TRUE;
-      break;
-    case SCENE_METHOD_CALL_REV:
-      if (STARTING_BLINK_CNT < scene_cnt
-          && scene_cnt < STARTING_BLINK_CNT+MOVING_CNT)
-      {
-        color_scope = TRUE;
-        reverse = REV;
-      }
-      break;
-  }
-
-  switch (direction)
-  {
-    case DIRECTION_GHUB_GAUTH:
-      xpos = mid_xpos;
-      ypos = down_ypos;
-      ht = 0;
-      vt *= -1;
-      break;
-    case DIRECTION_GHUB_GCTRL:
-      xpos = left_xpos;
-      ypos = down_ypos;
-      ht *= 1;
-      vt *= -1;
-      break;
-    case DIRECTION_GHUB_AGENT:
-      switch (scene)
-      {
-        case SCENE_POLICY_RELOAD:
-          if (ENDING_BLINK_CNT < scene_cnt
-              && scene_cnt < ENDING_BLINK_CNT+MOVING_CNT)
-          {
-            color_scope = TRUE;
-            reverse = REV;
-          }
-          break;
-      }
-      xpos = left_xpos;
-      ypos = mid_ypos;
-      vt = 0;
-      break;
-    case DIRECTION_AGENT_GPMS:
-      switch (scene)
-      {
-        case SCENE_POLICY_RELOAD:
-          if (STARTING_BLINK_CNT < scene_cnt
-              && scene_cnt < STARTING_BLINK_CNT+MOVING_CNT)
-            color_scope = TRUE;
-          break;
-      }
-      xpos = left_xpos;
-      ypos = mid_ypos;
-      vt = 0;
-      vert_bar = TRUE;
-      break;
-    case DIRECTION_GHUB_APPS:
-      xpos = mid_xpos;
-      ypos = up_ypos;
-      ht = 0;
-      vt *= 1;
-      break;
-    case DIRECTION_GHUB_CC:
-      xpos = left_xpos;
-      ypos = mid_ypos;
-      vt = 0;
-      vert_bar = TRUE;
-      break;
-  }
+  color_scope = moving && start < scene_cnt && scene_cnt < start + MOVING_CNT;
 
-  for (i = 0; i < 4; i++)
+  for (i = 0; i < CC_TOPOLOGY_DOTS; i++)
   {
     if (color_scope)
     {
       if (((scene_cnt+i+reverse)%2))
       {
         set_line_color (cr, color);
-        cairo_arc (cr, xpos+(ht*i), ypos+(vt*i), RADIUS_SMALL, 0, 2*M_PI);
+        cairo_arc (cr, xpos+(node->dot_dx*i), ypos+(node->dot_dy*i), RADIUS_SMALL, 0, 2*M_PI);
       }
       else
       {
         set_line_color (cr, COLOR_YELLOW);
-        cairo_arc (cr, xpos+(ht*i), ypos+(vt*i), RADIUS_LARGE, 0, 2*M_PI);
+        cairo_arc (cr, xpos+(node->dot_dx*i), ypos+(node->dot_dy*i), RADIUS_LARGE, 0, 2*M_PI);
       }
     }
     else
     {
       set_line_color (cr, color);
-      cairo_arc (cr, xpos+(ht*i), ypos+(vt*i), RADIUS_MEDIUM, 0, 2*M_PI);
+      cairo_arc (cr, xpos+(node->dot_dx*i), ypos+(node->dot_dy*i), RADIUS_MEDIUM, 0, 2*M_PI);
     }
     cairo_fill (cr);
   }
-
-  if (vert_bar)
-  {
-    set_line_color (cr, COLOR_BLACK);
-    cairo_set_dash (cr, dashed, 1, 0);
-    cairo_move_to (cr, 48, 0);
-    cairo_line_to (cr, 48, 73);
-    cairo_stroke (cr);
-  }
+  cc_lsf_trace_mark (trace, "Security framework", "Draw", "cell %d, scene %d", cell, scene);
 }
 
 static void
-scene_handler (CcSecurityFrameworkPanel *self)
+draw_node (GtkWidget      *widget,
+           cairo_t        *cr,
+           CcTopologyNode *node)
 {
-  if (self->scene == SCENE_IDLE)
+  GtkStyleContext *context = gtk_widget_get_style_context (widget);
+  PangoLayout *layout = NULL;
+  gint icon_width = 0, icon_height = 0;
+  gint text_width = 0, text_height = 0;
+  GdkRectangle ink;
+  gdouble scale_x, scale_y;
+  gdouble y;
+
+  if (node->icon)
   {
-    self->animating = FALSE;
-    self->scene_cnt = 0;
-    draw_lines (self);
+    cairo_surface_get_device_scale (node->icon, &scale_x, &scale_y);
+    icon_width = cairo_image_surface_get_width (node->icon) / scale_x;
+    icon_height = cairo_image_surface_get_height (node->icon) / scale_y;
   }
-  else
+  if (node->label)
   {
-    switch (self->scene_cnt)
-    {
-      case 0:
-        self->animating = TRUE;
-        switch (self->scene)
-        {
-          case SCENE_POLICY_RELOAD:
-            self->policy_reload_flag = TRUE;
-            break;
-          case SCENE_METHOD_CALL:
-          case SCENE_METHOD_CALL_REV:
-            if (self->policy_reload_flag
-                && self->policy_reload_seq != self->cur_seq)
-              self->policy_reload_flag = FALSE;
-            break;
-        }
-        enqueue_log_label (self, self->from_log);
-        break;
-      case 1: case 3: case 5:
-        switch (self->scene)
-        {
-          case SCENE_POLICY_RELOAD:
-            gtk_widget_set_opacity (self->gpms_image, 1.0);
-            break;
-          case SCENE_METHOD_CALL:
-          case SCENE_METHOD_CALL_REV:
-            switch (self->from)
-            {
-              case CC:
-                gtk_widget_set_opacity (self->cc_image, 1.0);
-                break;
-              case GHUB:
-                gtk_widget_set_opacity (self->ghub_image, 1.0);
-                break;
-              case GAUTH:
-                gtk_widget_set_opacity (self->gauth_image, 1.0);
-                break;
-              case GCTRL:
-                gtk_widget_set_opacity (self->gctrl_image, 1.0);
-                break;
-              case AGENT:
-                gtk_widget_set_opacity (self->agent_image, 1.0);
-                break;
-              case GPMS:
-                gtk_widget_set_opacity (self->gpms_image, 1.0);
-                break;
-              case APPS:
-                gtk_widget_set_opacity (apps[selected_app]->app_button, 1.0);
-                break;
-            }
-            break;
-        }
-        break;
-      case 2: case 4:
-        switch (self->scene)
-        {
-          case SCENE_POLICY_RELOAD:
-            gtk_widget_set_opacity (self->gpms_image, 0.3);
-            break;
-          case SCENE_METHOD_CALL:
-          case SCENE_METHOD_CALL_REV:
-            switch (self->from)
-            {
-              case CC:
-                gtk_widget_set_opacity (self->cc_image, 0.3);
-                break;
-              case GHUB:
-                gtk_widget_set_opacity (self->ghub_image, 0.3);
-                break;
-              case GAUTH:
-                gtk_widget_set_opacity (self->gauth_image, 0.3);
-                break;
-              case GCTRL:
-                gtk_widget_set_opacity (self->gctrl_image, 0.3);
-                break;
-              case AGENT:
-                gtk_widget_set_opacity (self->agent_image, 0.3);
-                break;
-              case GPMS:
-                gtk_widget_set_opacity (self->gpms_image, 0.3);
-                break;
-              case APPS:
-                gtk_widget_set_opacity (apps[selected_app]->app_button, 0.3);
-                break;
-            }
-            break;
-        }
-        draw_lines (self);
-        break;
-      case 6: case 7: case 8: case 9: case 10:
-        switch (self->scene)
-        {
-          case SCENE_POLICY_RELOAD:
-            gtk_widget_queue_draw (self->agent_gpms);
-            break;
-          case SCENE_METHOD_CALL:
-            switch (self->from)
-            {
-              case CC:
-                gtk_widget_queue_draw (self->ghub_cc);
-                break;
-              case GAUTH:
-                gtk_widget_queue_draw (self->ghub_gauth);
-                break;
-              case GCTRL:
-                gtk_widget_queue_draw (self->ghub_gctrl);
-                break;
-              case AGENT:
-                gtk_widget_queue_draw (self->ghub_agent);
-                break;
-              case APPS:
-                gtk_widget_queue_draw (self->ghub_apps);
-                break;
-              case GPMS:
-                gtk_widget_queue_draw (self->agent_gpms);
-                break;
-            }
-            break;
-          case SCENE_METHOD_CALL_REV:
-            switch (self->to)
-            {
-              case CC:
-                gtk_widget_queue_draw (self->ghub_cc);
-                break;
-              case GAUTH:
-                gtk_widget_queue_draw (self->ghub_gauth);
-                break;
-              case GCTRL:
-                gtk_widget_queue_draw (self->ghub_gctrl);
-                break;
-              case AGENT:
-                gtk_widget_queue_draw (self->ghub_agent);
-                break;
-              case APPS:
-                gtk_widget_queue_draw (self->ghub_apps);
-                break;
-              case GPMS:
-                gtk_widget_queue_draw (self->agent_gpms);
-                break;
-            }
-            break;
-        }
-        break;
-      case 11: case 13: case 15:
-        switch (self->scene)
-        {
-          case SCENE_POLICY_RELOAD:
-            gtk_widget_set_opacity (self->agent_image, 1.0);
-            break;
-          case SCENE_METHOD_CALL:
-          case SCENE_METHOD_CALL_REV:
-            switch (self->to)
-            {
-              case CC:
-                gtk_widget_set_opacity (self->cc_image, 1.0);
-                break;
-              case GHUB:
-                gtk_widget_set_opacity (self->ghub_image, 1.0);
-                break;
-              case GAUTH:
-                gtk_widget_set_opacity (self->gauth_image, 1.0);
-                break;
-              case GCTRL:
-                gtk_widget_set_opacity (self->gctrl_image, 1.0);
-                break;
-              case AGENT:
-                gtk_widget_set_opacity (self->agent_image, 1.0);
-                break;
-              case GPMS:
-                gtk_widget_set_opacity (self->gpms_image, 1.0);
-                break;
-              case APPS:
-                if (self->scene_cnt == 15 && !apps[selected_app]->exe_stat)
-                  gtk_widget_set_opacity (apps[selected_app]->app_button, 0.3);
-                else
-                  gtk_widget_set_opacity (apps[selected_app]->app_button, 1.0);
-                break;
-            }
-            break;
-        }
-        break;
-      case 12: case 14:
-        switch (self->scene)
-        {
-          case SCENE_POLICY_RELOAD:
-            gtk_widget_set_opacity (self->agent_image, 0.3);
-            break;
-          case SCENE_METHOD_CALL:
-          case SCENE_METHOD_CALL_REV:
-            switch (self->to)
-            {
-              case CC:
-                gtk_widget_set_opacity (self->cc_image, 0.3);
-                break;
-              case GHUB:
-                gtk_widget_set_opacity (self->ghub_image, 0.3);
-                break;
-              case GAUTH:
-                gtk_widget_set_opacity (self->gauth_image, 0.3);
-                break;
-              case GCTRL:
-                gtk_widget_set_opacity (self->gctrl_image, 0.3);
-                break;
-              case AGENT:
-                gtk_widget_set_opacity (self->agent_image, 0.3);
-                break;
-              case GPMS:
-                gtk_widget_set_opacity (self->gpms_image, 0.3);
-                break;
-              case APPS:
-                gtk_widget_set_opacity (apps[selected_app]->app_button, 0.3);
-                break;
-            }
-            break;
-        }
-        break;
-      case 16:
-        switch (self->scene)
-        {
-          case SCENE_POLICY_RELOAD:
-            self->scene = SCENE_METHOD_CALL;
-            self->from = AGENT;
-            self->to = GHUB;
-            break;
-          default:
-            self->scene = SCENE_IDLE;
-            self->animating = FALSE;
-            break;
-        }
-        self->scene_cnt = SCENE_END;
-        draw_lines (self);
-        break;
-    }
-    self->scene_cnt = (self->scene_cnt+1)%SCENE_CNT;
+    layout = gtk_widget_create_pango_layout (widget, node->label);
+    pango_layout_get_pixel_size (layout, &text_width, &text_height);
+    text_height += CC_TOPOLOGY_LABEL_SPACING;
   }
-}
-
-static int
-get_cell_ref (const char *dbus_name)
-{
-  int i;
 
-  for (i = CC; i < GPMS; i++)
+  y = node->rect.y + (node->rect.height - icon_height - text_height) / 2;
+  node->ink_rect.x = node->rect.x + (node->rect.width - icon_width) / 2;
+  node->ink_rect.y = y;
+  node->ink_rect.width = icon_width;
+  node->ink_rect.height = icon_height;
+  ink.x = node->rect.x + (node->rect.width - text_width) / 2;
+  ink.y = y + icon_height;
+  ink.width = text_width;
+  ink.height = text_height;
+  gdk_rectangle_union (&node->ink_rect, &ink, &node->ink_rect);
+
+  /* The module state dims the whole node, a blink only its icon. */
+  cairo_push_group (cr);
+  if (node->icon)
   {
-    if (!g_strcmp0 (dbus_name, lsf_dbus_name[i]))
-      return i;
+    cairo_set_source_surface (cr, node->icon,
+                              node->rect.x + (node->rect.width - icon_width) / 2, y);
+    cairo_paint_with_alpha (cr, node->blink);
   }
-
-  return APPS;
+  if (layout)
+  {
+    gtk_render_layout (context, cr,
+                       node->rect.x + (node->rect.width - text_width) / 2,
+                       y + icon_height + CC_TOPOLOGY_LABEL_SPACING,
+                       layout);
+    g_object_unref (layout);
+  }
+  cairo_pop_group_to_source (cr);
+  cairo_paint_with_alpha (cr, node->opacity);
 }
 
-static void
-get_scene (CcSecurityFrameworkPanel *self)
+/* The area being repainted, or NULL if it is the whole canvas. */
+static cairo_region_t *
+get_clip_region (cairo_t *cr)
 {
-  gchar **log_str;
-  gchar **args;
-  security_app *app;
-  char *from;
-  char *to;
-  char buf[DEFAULT_BUF_SIZE];
+  cairo_rectangle_list_t *list = cairo_copy_clip_rectangle_list (cr);
+  cairo_region_t *region = NULL;
+  GdkRectangle rect;
+  int i;
 
-  if (self->scene == SCENE_IDLE)
+  if (list->status == CAIRO_STATUS_SUCCESS)
   {
-    if (self->fp == NULL)
-    {
-      self->fp = fopen (self->tailing_file, "r");
-      if (self->fp != NULL)
-      {
-        fseek (self->fp, 0, SEEK_END);
-        self->fpos = ftell (self->fp);
-      }
-      else
-        return;
-    }
-    else
-      fseek (self->fp, self->fpos, SEEK_SET);
-
-    if (fgets (buf, DEFAULT_BUF_SIZE, self->fp) == NULL)
+    region = cairo_region_create ();
+    for (i = 0; i < list->num_rectangles; i++)
     {
-      self->scene = SCENE_IDLE;
-      return;
+      rect.x = floor (list->rectangles[i].x);
+      rect.y = floor (list->rectangles[i].y);
+      rect.width = ceil (list->rectangles[i].x + list->rectangles[i].width) - rect.x;
+      rect.height = ceil (list->rectangles[i].y + list->rectangles[i].height) - rect.y;
+      cairo_region_union_rectangle (region, &rect);
     }
+  }
+  cairo_rectangle_list_destroy (list);
 
-    log_str = g_strsplit (buf, " ", 0);
-    args = g_strsplit (log_str[2], ",", 0);
-    self->cur_seq = atoi (args[DMSG_SEQ]);
-    self->from = get_cell_ref (args[DMSG_FROM]);
-    self->to = get_cell_ref (args[DMSG_TO]);
+  return region;
+}
 
-    if (self->from == -1 || self->to == -1)
-    {
-      self->fpos = ftell (self->fp);
-      g_strfreev (args);
-      g_strfreev (log_str);
-      return;
-    }
+static gboolean
+in_clip (cairo_region_t     *clip,
+         const GdkRectangle *rect)
+{
+  return !clip ||
+         cairo_region_contains_rectangle (clip, rect) != CAIRO_REGION_OVERLAP_OUT;
+}
 
-    if (self->from == APPS)
-    {
-      app = find_app (self, args[DMSG_FROM]);
-      if (app)
-      {
-        from = app->display_name;
-        selected_app = app->app_idx;
-      }
-      else
-        from = args[DMSG_FROM];
-    }
-    else
-      from = module_name[self->from];
+/* Only the connections and nodes that meet the damaged area are drawn,
+ * cairo clips everything else. */
+static gboolean
+draw_topology (GtkWidget *widget,
+               cairo_t   *cr,
+               gpointer   user_data)
+{
+  CcSecurityFrameworkPanel *self = CC_SECURITY_FRAMEWORK_PANEL (user_data);
+  CcTopologyNode *node;
+  cairo_region_t *clip;
+  GdkRectangle extents;
+  const gdouble *separators;
+  double dashed[] = { 3.0 };
+  guint n_separators;
+  guint i;
 
-    if (self->to == APPS)
-    {
-      app = find_app (self, args[DMSG_TO]);
-      if (app)
-      {
-        to = app->display_name;
-        selected_app = app->app_idx;
-      }
-      else
-        from = args[DMSG_TO];
-    }
-    else
-      to = module_name[self->to];
+  if (cc_security_topology_layout (self->graph,
+                                   gtk_widget_get_allocated_width (widget),
+                                   gtk_widget_get_allocated_height (widget)))
+    clip = NULL;
+  else
+    clip = get_clip_region (cr);
 
-    self->from_log = g_strconcat (from, "\t-->\t", to, "\t", args[DMSG_GLYPH], " , ", args[DMSG_FUNC], NULL);
+  for (i = 0; i < cc_security_topology_get_n_nodes (self->graph); i++)
+  {
+    node = cc_security_topology_get_node (self->graph, i);
+    if (node->parent >= 0 && in_clip (clip, &node->edge_rect))
+      do_drawing (cr, node, i, (gint) i == self->active_edge, self->scene, self->scene_cnt);
+  }
 
-    if (!g_strcmp0 (args[DMSG_GLYPH], "O") &&
-        self->from == AGENT &&
-        self->to == GHUB)
-    {
-      self->policy_reload_seq = atoi (args[DMSG_SEQ]);
-      self->scene = SCENE_POLICY_RELOAD;
-    }
-    else
-    {
-      if (self->from == GHUB)
-        self->scene = SCENE_METHOD_CALL_REV;
-      else
-        self->scene = SCENE_METHOD_CALL;
-    }
+  separators = cc_security_topology_get_separators (self->graph, &n_separators);
+  cairo_save (cr);
+  set_line_color (cr, COLOR_BLACK);
+  cairo_set_line_width (cr, 2.0);
+  cairo_set_dash (cr, dashed, 1, 0);
+  for (i = 0; i < n_separators; i++)
+  {
+    cairo_move_to (cr, separators[i], 0);
+    cairo_line_to (cr, separators[i], gtk_widget_get_allocated_height (widget));
+  }
+  cairo_stroke (cr);
+  cairo_restore (cr);
 
-    if (args)
-      g_strfreev (args);
+  for (i = 0; i < cc_security_topology_get_n_nodes (self->graph); i++)
+  {
+    node = cc_security_topology_get_node (self->graph, i);
+    gdk_rectangle_union (&node->rect, &node->ink_rect, &extents);
+    if (in_clip (clip, &extents))
+      draw_node (widget, cr, node);
+  }
 
-    if (log_str)
-      g_strfreev (log_str);
+  if (clip)
+    cairo_region_destroy (clip);
 
-    self->fpos = ftell (self->fp);
-  }
+  return FALSE;
+}
+
+static void
+topology_scale_changed (GtkWidget  *widget,
+                        GParamSpec *pspec,
+                        gpointer    user_data)
+{
+  CcSecurityFrameworkPanel *self = CC_SECURITY_FRAMEWORK_PANEL (user_data);
+
+  cc_security_topology_set_scale (self->graph, gtk_widget_get_scale_factor (widget));
+  gtk_widget_queue_draw (widget);
+}
+
+/* The modules with actions keep a focusable, accessible button of their
+ * own, laid over the module's cell of the canvas. */
+static gboolean
+get_cell_button_position (GtkOverlay   *overlay,
+                          GtkWidget    *widget,
+                          GdkRectangle *allocation,
+                          gpointer      user_data)
+{
+  CcSecurityFrameworkPanel *self = CC_SECURITY_FRAMEWORK_PANEL (user_data);
+  CcTopologyNode *node;
+
+  if (widget == self->perf_label)
+    return FALSE;
+
+  cc_security_topology_layout (self->graph,
+                               gtk_widget_get_allocated_width (self->topology_area),
+                               gtk_widget_get_allocated_height (self->topology_area));
+  node = cc_security_topology_get_node (self->graph,
+                                        GPOINTER_TO_INT (g_object_get_data (G_OBJECT (widget), "cell")));
+  gtk_widget_translate_coordinates (self->topology_area, GTK_WIDGET (overlay),
+                                    node->rect.x, node->rect.y,
+                                    &allocation->x, &allocation->y);
+  allocation->width = node->rect.width;
+  allocation->height = node->rect.height;
+
+  return TRUE;
+}
+
+static GtkWidget *
+add_cell_button (CcSecurityFrameworkPanel *self,
+                 gint                      cell)
+{
+  CcTopologyNode *node = cc_security_topology_get_node (self->graph, cell);
+  GtkWidget *button;
+
+  button = gtk_button_new ();
+  gtk_button_set_relief (GTK_BUTTON (button), GTK_RELIEF_NONE);
+  atk_object_set_name (gtk_widget_get_accessible (button), node->label);
+  g_object_set_data (G_OBJECT (button), "cell", GINT_TO_POINTER (cell));
+  gtk_overlay_add_overlay (GTK_OVERLAY (self->scene_overlay), button);
+  gtk_widget_show (button);
+
+  return button;
+}
+
+/* Clicks go where they went when each module was a button; Enter,
+ * Space or the menu key open the menu of GController and Agent. */
+static void
+add_cell_buttons (CcSecurityFrameworkPanel *self)
+{
+  GtkWidget *button;
+
+  button = add_cell_button (self, GPMS);
+  g_signal_connect (G_OBJECT (button),
+                    "clicked",
+                    G_CALLBACK (gpms_cell_clicked),
+                    self);
+
+  button = add_cell_button (self, GCTRL);
+  g_signal_connect (G_OBJECT (button),
+                    "button-press-event",
+                    G_CALLBACK (gctrl_cell_clicked),
+                    self);
+  g_signal_connect (G_OBJECT (button),
+                    "clicked",
+                    G_CALLBACK (cell_menu_requested),
+                    self->gctrl_menu);
+  g_signal_connect (G_OBJECT (button),
+                    "popup-menu",
+                    G_CALLBACK (cell_menu_requested),
+                    self->gctrl_menu);
+
+  button = add_cell_button (self, AGENT);
+  g_signal_connect (G_OBJECT (button),
+                    "button-press-event",
+                    G_CALLBACK (agent_cell_clicked),
+                    self);
+  g_signal_connect (G_OBJECT (button),
+                    "clicked",
+                    G_CALLBACK (cell_menu_requested),
+                    self->agent_menu);
+  g_signal_connect (G_OBJECT (button),
+                    "popup-menu",
+                    G_CALLBACK (cell_menu_requested),
+                    self->agent_menu);
+
+  g_signal_connect (G_OBJECT (self->scene_overlay),
+                    "get-child-position",
+                    G_CALLBACK (get_cell_button_position),
+                    self);
+}
+
+static void
+update_topology_size (CcSecurityFrameworkPanel *self)
+{
+  gint width, height;
+
+  cc_security_topology_get_size (self->graph, &width, &height);
+  gtk_widget_set_size_request (self->topology_area, width, height);
+  gtk_widget_queue_draw (self->topology_area);
+}
+
+/* The fixed modules of the framework, in cell order so that a cell is
+ * also the index of its node, and the layers they sit in: Control
+ * Center, the LSF daemons around GHUB, and GPMS. Other daemons are
+ * added as the module list names them. */
+static void
+build_topology (CcSecurityFrameworkPanel *self)
+{
+  self->graph = cc_security_topology_new (RESOURCE_DIR,
+                                          gtk_widget_get_scale_factor (self->topology_area));
+  cc_security_topology_add_node (self->graph, CC_DBUS, _("Control Center"), CC_IMG, 0, 2, GHUB);
+  cc_security_topology_add_node (self->graph, GHUB_DBUS, _("GHub"), GHUB_IMG, 2, 2, -1);
+  cc_security_topology_add_node (self->graph, GAUTH_DBUS, _("GAuth"), GAUTH_IMG, 2, 0, GHUB);
+  cc_security_topology_add_node (self->graph, GCTRL_DBUS, _("GController"), GCTRL_IMG, 4, 0, GHUB);
+  cc_security_topology_add_node (self->graph, AGENT_DBUS, _("Agent"), AGENT_IMG, 4, 2, GHUB);
+  cc_security_topology_add_node (self->graph, NULL, "GPMS", GPMS_IMG, 6, 2, AGENT);
+  cc_security_topology_add_node (self->graph, NULL, NULL, APPS_HUB_IMG, 2, 4, GHUB);
+  cc_security_topology_add_separator (self->graph, 1);
+  cc_security_topology_add_separator (self->graph, 5);
+
+  update_topology_size (self);
+}
+
+/* Modules with a cell of their own keep it. Of the others, those that
+ * installed a panel are apps and share the apps cell; any other is an
+ * LSF daemon and has a node of its own in the daemon layer, added the
+ * first time it is asked for. */
+static gint
+get_module_cell (CcSecurityFrameworkPanel *self,
+                 security_app             *app)
+{
+  CcTopologyNode *node;
+  gint cell = cc_lsf_scene_get_cell (app->dbus_name);
+  guint i;
+
+  if (cell != APPS
+      || cc_security_apps_registry_has_app (cc_security_apps_registry_get_default (),
+                                            app->dbus_name))
+    return cell;
+
+  for (i = CELL_NUM; i < cc_security_topology_get_n_nodes (self->graph); i++)
+  {
+    node = cc_security_topology_get_node (self->graph, i);
+    if (!g_strcmp0 (node->dbus_name, app->dbus_name))
+      return i;
+  }
+
+  node = cc_security_topology_get_node (self->graph, GCTRL);
+  return cc_security_topology_add_node (self->graph, app->dbus_name, app->display_name,
+                                        DAEMON_IMG, node->column, -1, GHUB);
+}
+
+/* What each tick of a scene does. Every scene blinks its source cell,
+ * runs the dots along one connection and blinks its target cell. */
+static const gint8 scene_keyframes[SCENE_CNT] = {
+  KEYFRAME_START,
+  KEYFRAME_SOURCE_ON, KEYFRAME_SOURCE_OFF,
+  KEYFRAME_SOURCE_ON, KEYFRAME_SOURCE_OFF,
+  KEYFRAME_SOURCE_ON,
+  KEYFRAME_EDGE, KEYFRAME_EDGE, KEYFRAME_EDGE, KEYFRAME_EDGE, KEYFRAME_EDGE,
+  KEYFRAME_TARGET_ON, KEYFRAME_TARGET_OFF,
+  KEYFRAME_TARGET_ON, KEYFRAME_TARGET_OFF,
+  KEYFRAME_TARGET_SETTLE,
+  KEYFRAME_END,
+};
+
+/* The cells a scene involves: a cell, or the sender or receiver of the
+ * logged message. A policy reload goes on as the agent's call to GHUB. */
+#define CELL_FROM  -1
+#define CELL_TO    -2
+
+static const struct
+{
+  gint source;
+  gint edge;
+  gint target;
+  gint next;
+  gint next_from;
+  gint next_to;
+} scene_scripts[SCENE_NUM] = {
+  [SCENE_METHOD_CALL]     = { CELL_FROM, CELL_FROM, CELL_TO, SCENE_IDLE, 0, 0 },
+  [SCENE_METHOD_CALL_REV] = { CELL_FROM, CELL_TO,   CELL_TO, SCENE_IDLE, 0, 0 },
+  [SCENE_POLICY_RELOAD]   = { GPMS,      GPMS,      AGENT,   SCENE_METHOD_CALL, AGENT, GHUB },
+};
+
+static gint
+resolve_cell (CcSecurityFrameworkPanel *self,
+              gint                      cell)
+{
+  if (cell == CELL_FROM)
+    return self->from;
+  if (cell == CELL_TO)
+    return self->to;
+  return cell;
+}
+
+/* A blink of the apps cell shows on the app's own button, which comes
+ * and goes with the app, so it is looked up each time. */
+static void
+set_cell_opacity (CcSecurityFrameworkPanel *self,
+                  gint                      cell,
+                  gdouble                   opacity)
+{
+  CcTopologyNode *node;
+
+  if (cell != APPS)
+  {
+    node = cc_security_topology_get_node (self->graph, cell);
+    if (node->blink != opacity)
+    {
+      node->blink = opacity;
+      cc_security_topology_damage_node (self->graph, cell);
+    }
+  }
+  else if (apps[selected_app])
+    set_button_opacity (apps[selected_app], opacity);
+}
+
+static void
+scene_handler (CcSecurityFrameworkPanel *self)
+{
+  gint edge;
+  gint target;
+
+  if (self->scene == SCENE_IDLE)
+  {
+    self->animating = FALSE;
+    self->scene_cnt = 0;
+    return;
+  }
+
+  switch (scene_keyframes[self->scene_cnt])
+  {
+    case KEYFRAME_START:
+      self->animating = TRUE;
+      if (self->scene == SCENE_POLICY_RELOAD)
+        self->policy_reload_flag = TRUE;
+      else if (self->policy_reload_flag
+               && self->policy_reload_seq != self->cur_seq)
+        self->policy_reload_flag = FALSE;
+      enqueue_log_label (self, self->from_log);
+      self->active_edge = resolve_cell (self, scene_scripts[self->scene].edge);
+      break;
+    case KEYFRAME_SOURCE_ON:
+      set_cell_opacity (self, resolve_cell (self, scene_scripts[self->scene].source), 1.0);
+      break;
+    case KEYFRAME_SOURCE_OFF:
+      set_cell_opacity (self, resolve_cell (self, scene_scripts[self->scene].source), 0.3);
+      break;
+    case KEYFRAME_EDGE:
+      edge = resolve_cell (self, scene_scripts[self->scene].edge);
+      cc_security_topology_damage_edge (self->graph, edge);
+      break;
+    case KEYFRAME_TARGET_ON:
+      set_cell_opacity (self, resolve_cell (self, scene_scripts[self->scene].target), 1.0);
+      break;
+    case KEYFRAME_TARGET_OFF:
+      set_cell_opacity (self, resolve_cell (self, scene_scripts[self->scene].target), 0.3);
+      break;
+    case KEYFRAME_TARGET_SETTLE:
+      /* A stopped app is left dimmed. */
+      target = resolve_cell (self, scene_scripts[self->scene].target);
+      if (target == APPS && apps[selected_app] && !apps[selected_app]->exe_stat)
+        set_cell_opacity (self, target, 0.3);
+      else
+        set_cell_opacity (self, target, 1.0);
+      break;
+    case KEYFRAME_END:
+      if (scene_scripts[self->scene].next != SCENE_IDLE)
+      {
+        self->from = scene_scripts[self->scene].next_from;
+        self->to = scene_scripts[self->scene].next_to;
+      }
+      else
+        self->animating = FALSE;
+      self->scene = scene_scripts[self->scene].next;
+      self->scene_cnt = SCENE_END;
+      self->active_edge = -1;
+      break;
+  }
+  self->scene_cnt = (self->scene_cnt+1)%SCENE_CNT;
+  draw_lines (self);
+}
+
+/* Log lines name modules by D-Bus name. A daemon's messages run to its
+ * own node; of apps, the one named last is the app whose button the
+ * scene blinks. */
+static const gchar *
+get_app_display_name (const gchar *dbus_name,
+                      CcLsfCell   *cell,
+                      gpointer     user_data)
+{
+  security_app *app = find_app (CC_SECURITY_FRAMEWORK_PANEL (user_data), dbus_name);
+
+  if (!app)
+    return NULL;
+
+  if (app->cell_ref != APPS)
+    *cell = app->cell_ref;
+  else
+    selected_app = app->app_idx;
+  return app->display_name;
+}
+
+static void
+get_scene (CcSecurityFrameworkPanel *self)
+{
+  CcLsfSceneEvent event;
+
+  if (self->scene != SCENE_IDLE || !cc_lsf_scene_reader_next (self->log_reader, &event))
+    return;
+
+  self->cur_seq = event.seq;
+  self->from = event.from;
+  self->to = event.to;
+  self->scene = event.scene;
+  if (event.scene == SCENE_POLICY_RELOAD)
+    self->policy_reload_seq = event.seq;
+
+  g_free (self->from_log);
+  self->from_log = event.label;
 }
 
 static gboolean
 scene_presenter (CcSecurityFrameworkPanel *self)
 {
+  gint64 start = g_get_monotonic_time ();
+
+  if (cc_lsf_trace_enabled ())
+    cc_lsf_trace_counter (CC_LSF_TRACE_LOG_BACKLOG, cc_lsf_scene_reader_get_backlog (self->log_reader));
+
   if (!self->animating)
     get_scene (self);
   scene_handler (self);
 
+  self->presenter_time = g_get_monotonic_time () - start;
+  self->presenter_max = MAX (self->presenter_max, self->presenter_time);
+
   return TRUE;
 }
 
@@ -1289,15 +1221,29 @@ GET_TOPOLOGY_ERROR:
   return ret;
 }
 
+static void
+free_app (security_app *app)
+{
+  if (app->app_button)
+    gtk_widget_destroy (app->app_button);
+  if (app->app_menu)
+    gtk_widget_destroy (app->app_menu);
+  g_free (app->dbus_name);
+  g_free (app->display_name);
+  free (app);
+}
+
+/* Fills modules with new records, one per module of the reply. */
 static int
-resp_parser (char *resp)
+resp_parser (char          *resp,
+             security_app **modules)
 {
   security_app *app = NULL;
   struct json_object *resp_obj = NULL;
   struct json_object *module_obj = NULL;
   struct json_object *field_iter = NULL;
   struct json_object *stat_iter = NULL;
-  int i, j;
+  int i = 0;
   int module_len;
 
   resp_obj = json_tokener_parse (resp);
@@ -1305,28 +1251,23 @@ resp_parser (char *resp)
   if (!resp_obj) goto RESP_PARSER_ERROR;
   if (!json_object_object_get_ex (resp_obj, "return", &resp_obj)) goto RESP_PARSER_ERROR;
   if (!json_object_object_get_ex (resp_obj, "result", &resp_obj)) goto RESP_PARSER_ERROR;
-  module_len = json_object_array_length (resp_obj);
+  module_len = MIN (json_object_array_length (resp_obj), APPS_MAX);
   if (module_len <= 0) goto RESP_PARSER_ERROR;
   for (i = 0; i < module_len; i++)
   {
     module_obj = json_object_array_get_idx (resp_obj, i);
     if (!module_obj) goto RESP_PARSER_ERROR;
 
-    if (apps[i])
-    {
-      free (apps[i]);
-      apps[i] = NULL;
-    }
-    apps[i] = (security_app *) calloc (1, sizeof (security_app));
-    apps[i]->set = FALSE;
-    apps[i]->app_idx = i;
+    modules[i] = app = (security_app *) calloc (1, sizeof (security_app));
+    app->set = FALSE;
+    app->app_idx = i;
 
     if (!json_object_object_get_ex (module_obj, "dbus_name", &field_iter)) goto RESP_PARSER_ERROR;
-    apps[i]->dbus_name = g_strdup (json_object_get_string (field_iter));
-    apps[i]->cell_ref = get_cell_ref (apps[i]->dbus_name);
+    app->dbus_name = g_strdup (json_object_get_string (field_iter));
+    app->cell_ref = cc_lsf_scene_get_cell (app->dbus_name);
 
     if (!json_object_object_get_ex (module_obj, "display_name", &field_iter)) goto RESP_PARSER_ERROR;
-    apps[i]->display_name = g_strdup (json_object_get_string (field_iter));
+    app->display_name = g_strdup (json_object_get_string (field_iter));
 
     if (!json_object_object_get_ex (module_obj, "status", &field_iter)) goto RESP_PARSER_ERROR;
     field_iter = json_object_array_get_idx (field_iter, 0);
@@ -1335,17 +1276,17 @@ resp_parser (char *resp)
     if (!json_object_object_get_ex (field_iter, "exe_stat", &stat_iter)) goto RESP_PARSER_ERROR;
     if (!g_strcmp0 (json_object_get_string (stat_iter), "running"))
     {
-      apps[i]->exe_stat = TRUE;
+      app->exe_stat = TRUE;
       if (!json_object_object_get_ex (field_iter, "auth_stat", &stat_iter)) goto RESP_PARSER_ERROR;
       if (!g_strcmp0 (json_object_get_string (stat_iter), "auth"))
-        apps[i]->auth_stat = TRUE;
+        app->auth_stat = TRUE;
       else
-        apps[i]->auth_stat = FALSE;
+        app->auth_stat = FALSE;
     }
     else
     {
-      apps[i]->exe_stat = FALSE;
-      apps[i]->auth_stat = FALSE;
+      app->exe_stat = FALSE;
+      app->auth_stat = FALSE;
     }
 
   }
@@ -1357,114 +1298,395 @@ RESP_PARSER_ERROR:
   if (resp_obj) json_object_put (resp_obj);
   if (field_iter) json_object_put (field_iter);
   if (module_obj) json_object_put (module_obj);
+  for (; i >= 0; i--)
+    if (modules[i])
+      free_app (modules[i]);
 
   return -1;
 }
 
 static void
-set_apps (CcSecurityFrameworkPanel *self)
+add_app_button (CcSecurityFrameworkPanel *self,
+                security_app             *app)
 {
   GtkWidget *menu_item;
+  cairo_surface_t *icon;
   char img_file[BUFSIZ];
-  int i, j;
 
-  gtk_widget_destroy (self->apps_list);
-  self->apps_list = gtk_box_new (GTK_ORIENTATION_HORIZONTAL, 10);
-  gtk_container_add (GTK_CONTAINER (self->apps_view), self->apps_list);
+  app->app_button = gtk_button_new_with_label (app->display_name);
+  app->opacity = 1.0;
+  snprintf (img_file,
+            BUFSIZ,
+            LSF_CC_PANEL_DIR "/%s/resources/icon/app.svg",
+            app->dbus_name);
+  if (access (img_file, R_OK) == 0)
+    gtk_button_set_image (GTK_BUTTON (app->app_button), gtk_image_new_from_file (img_file));
+  else
+  {
+    icon = cc_security_topology_load_icon (RESOURCE_DIR, APPS_IMG,
+                                           gtk_widget_get_scale_factor (self->apps_list));
+    gtk_button_set_image (GTK_BUTTON (app->app_button), gtk_image_new_from_surface (icon));
+    if (icon)
+      cairo_surface_destroy (icon);
+  }
+
+  gtk_button_set_image_position (GTK_BUTTON (app->app_button), GTK_POS_TOP);
+  gtk_button_set_always_show_image (GTK_BUTTON (app->app_button), TRUE);
+  gtk_button_set_relief (GTK_BUTTON (app->app_button), GTK_RELIEF_NONE);
 
-  for (i = 0; i < self->apps_num; i++)
+  if (!g_strcmp0 (app->dbus_name, "kr.gooroom.ahnlab.v3"))
+    g_signal_connect (G_OBJECT (app->app_button),
+                      "button-press-event",
+                      G_CALLBACK (v3_cell_clicked),
+                      app);
+  else
+    g_signal_connect (G_OBJECT (app->app_button),
+                      "button-press-event",
+                      G_CALLBACK (app_cell_clicked),
+                      app);
+  gtk_widget_show_all (app->app_button);
+
+  app->app_menu = gtk_menu_new ();
+  menu_item = gtk_menu_item_new_with_label (_("Launch"));
+  gtk_menu_attach (GTK_MENU (app->app_menu), menu_item, 0, 1, 0, 1);
+  g_object_set_data (G_OBJECT (menu_item), "app", app);
+  g_signal_connect (G_OBJECT (menu_item),
+                    "activate",
+                    G_CALLBACK (app_menu_handler),
+                    self);
+  menu_item = gtk_menu_item_new_with_label (_("Kill"));
+  gtk_menu_attach (GTK_MENU (app->app_menu), menu_item, 0, 1, 1, 2);
+  g_object_set_data (G_OBJECT (menu_item), "app", app);
+  g_signal_connect (G_OBJECT (menu_item),
+                    "activate",
+                    G_CALLBACK (app_menu_handler),
+                    self);
+  gtk_widget_show_all (app->app_menu);
+
+  gtk_container_add (GTK_CONTAINER (self->apps_list), app->app_button);
+  app->set = TRUE;
+}
+
+/* A scene running through the node is cut short, any other keeps
+ * pointing at the same nodes. */
+static void
+remove_daemon_node (CcSecurityFrameworkPanel *self,
+                    gint                      cell)
+{
+  if (self->scene != SCENE_IDLE)
   {
-    if (APPS == apps[i]->cell_ref)
+    if (self->from == cell || self->to == cell)
     {
-      apps[i]->app_button = gtk_button_new_with_label (apps[i]->display_name);
-      snprintf (img_file,
-                BUFSIZ,
-                "/var/tmp/lsf/lsf-cc-panel/%s/resources/icon/app.svg",
-                apps[i]->dbus_name);
-      if (access (img_file, R_OK) == 0)
-        gtk_button_set_image (GTK_BUTTON (apps[i]->app_button), gtk_image_new_from_file (img_file));
-      else
-        gtk_button_set_image (GTK_BUTTON (apps[i]->app_button), gtk_image_new_from_resource (APPS_IMG));
+      if (self->from != cell)
+        set_cell_opacity (self, self->from, 1.0);
+      if (self->to != cell)
+        set_cell_opacity (self, self->to, 1.0);
+      self->scene = SCENE_IDLE;
+      self->scene_cnt = 0;
+      self->animating = FALSE;
+      self->active_edge = -1;
+    }
+    else
+    {
+      if (self->from > cell)
+        self->from--;
+      if (self->to > cell)
+        self->to--;
+      if (self->active_edge > cell)
+        self->active_edge--;
+    }
+  }
 
-      gtk_button_set_image_position (GTK_BUTTON (apps[i]->app_button), GTK_POS_TOP);
-      gtk_button_set_always_show_image (GTK_BUTTON (apps[i]->app_button), TRUE);
-      gtk_button_set_relief (GTK_BUTTON (apps[i]->app_button), GTK_RELIEF_NONE);
+  cc_security_topology_remove_node (self->graph, cell);
+}
 
-      if (!g_strcmp0 (apps[i]->dbus_name, "kr.gooroom.ahnlab.v3"))
-        g_signal_connect (G_OBJECT (apps[i]->app_button),
-                          "button-press-event",
-                          G_CALLBACK (v3_cell_clicked),
-                          GINT_TO_POINTER (i));
-      else
-        g_signal_connect (G_OBJECT (apps[i]->app_button),
-                          "button-press-event",
-                          G_CALLBACK (app_cell_clicked),
-                          GINT_TO_POINTER (i));
-      gtk_widget_show_all (apps[i]->app_button);
-
-      apps[i]->app_menu = gtk_menu_new ();
-      menu_item = gtk_menu_item_new_with_label (_("Launch"));
-      gtk_menu_attach (GTK_MENU (apps[i]->app_menu), menu_item, 0, 1, 0, 1);
-      g_signal_connect (G_OBJECT (menu_item),
-                        "activate",
-                        G_CALLBACK (app_menu_handler),
-                        GINT_TO_POINTER (i));
-      g_signal_connect_after (G_OBJECT (menu_item),
-                              "activate",
-                              G_CALLBACK (module_state_update),
-                              self);
-      menu_item = gtk_menu_item_new_with_label (_("Kill"));
-      gtk_menu_attach (GTK_MENU (apps[i]->app_menu), menu_item, 0, 1, 1, 2);
-      g_signal_connect (G_OBJECT (menu_item),
-                        "activate",
-                        G_CALLBACK (app_menu_handler),
-                        GINT_TO_POINTER (i));
-      g_signal_connect_after (G_OBJECT (menu_item),
-                              "activate",
-                              G_CALLBACK (module_state_update),
-                              self);
-      gtk_widget_show_all (apps[i]->app_menu);
-
-      gtk_container_add (GTK_CONTAINER (self->apps_list), apps[i]->app_button);
-      apps[i]->set = TRUE;
+/* Brings the daemon nodes and app buttons in line with the module list
+ * and the installed apps. A module turns from daemon into app and back
+ * as its panel is installed and removed, and the node of a daemon goes
+ * away with it. */
+static void
+update_module_cells (CcSecurityFrameworkPanel *self)
+{
+  CcSecurityAppsRegistry *registry = cc_security_apps_registry_get_default ();
+  CcTopologyNode *node;
+  security_app *app;
+  gboolean removed = FALSE;
+  guint n_nodes;
+  int i;
+  int position = 0;
+  int old_position;
+
+  for (i = cc_security_topology_get_n_nodes (self->graph); i > CELL_NUM; i--)
+  {
+    node = cc_security_topology_get_node (self->graph, i - 1);
+    if (find_app (self, node->dbus_name)
+        && !cc_security_apps_registry_has_app (registry, node->dbus_name))
+      continue;
+
+    remove_daemon_node (self, i - 1);
+    removed = TRUE;
+  }
+  n_nodes = cc_security_topology_get_n_nodes (self->graph);
+
+  for (i = 0; i < self->apps_num; i++)
+  {
+    app = apps[i];
+    app->cell_ref = get_module_cell (self, app);
+    if (app->cell_ref != APPS)
+    {
+      g_clear_pointer (&app->app_button, gtk_widget_destroy);
+      g_clear_pointer (&app->app_menu, gtk_widget_destroy);
+      app->set = FALSE;
+      continue;
     }
+
+    if (!app->app_button)
+      add_app_button (self, app);
+    gtk_container_child_get (GTK_CONTAINER (self->apps_list), app->app_button,
+                             "position", &old_position, NULL);
+    if (old_position != position)
+      gtk_box_reorder_child (GTK_BOX (self->apps_list), app->app_button, position);
+    position++;
   }
-  gtk_widget_show_all (self->apps_list);
+
+  if (removed || cc_security_topology_get_n_nodes (self->graph) != n_nodes)
+    update_topology_size (self);
 }
 
-static gboolean
-modules_state_updater (CcSecurityFrameworkPanel *self)
+/* Takes over the records of a new module list. A module that was listed
+ * before keeps its record, and with it its button, menu and the state
+ * last applied to them; only buttons of modules that came or went are
+ * created or destroyed. */
+static void
+set_apps (CcSecurityFrameworkPanel *self,
+          security_app            **modules,
+          int                       modules_num)
 {
-  GThread *thr;
+  security_app *app;
   int i, j;
-  int target_cell;
-  int ret_num;
-  char *ret = NULL;
-  gboolean err = FALSE;
-
-  thr = g_thread_new (NULL, (gpointer) dbus_message_sender, GINT_TO_POINTER (GET_STATUS));
-  ret = (char *) g_thread_join (thr);
 
-  if (!ret)
-    err = TRUE;
-  else
+  for (i = 0; i < modules_num; i++)
   {
-    ret_num = resp_parser (ret);
-    if (ret_num == -1)
-      err = TRUE;
-    else
+    app = find_app (self, modules[i]->dbus_name);
+    if (app)
     {
-      if (self->apps_num != ret_num)
-        self->apps_num = ret_num;
+      app->exe_stat = modules[i]->exe_stat;
+      app->auth_stat = modules[i]->auth_stat;
+      if (g_strcmp0 (app->display_name, modules[i]->display_name))
+      {
+        g_free (app->display_name);
+        app->display_name = g_strdup (modules[i]->display_name);
+        if (app->app_button)
+          gtk_button_set_label (GTK_BUTTON (app->app_button), app->display_name);
+      }
+      app->app_idx = i;
+      free_app (modules[i]);
+      modules[i] = app;
     }
   }
 
-  set_apps (self);
+  /* What is left of the old list went away. */
+  for (i = 0; i < self->apps_num; i++)
+  {
+    for (j = 0; j < modules_num && modules[j] != apps[i]; j++);
+    if (j == modules_num)
+      free_app (apps[i]);
+    apps[i] = NULL;
+  }
+
+  for (i = 0; i < modules_num; i++)
+    apps[i] = modules[i];
+  self->apps_num = modules_num;
+
+  update_module_cells (self);
+}
+
+static void
+installed_apps_changed (CcSecurityFrameworkPanel *self,
+                        const char               *dbus_name)
+{
+  update_module_cells (self);
   set_modules_opacity (self);
+}
+
+static gboolean
+modules_state_timeout (gpointer user_data)
+{
+  CcSecurityFrameworkPanel *self = (CcSecurityFrameworkPanel *) user_data;
+
+  self->event_source_tag[SOURCE_FUNC_UPDATER] = 0;
+  modules_state_updater (self);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+schedule_modules_state_update (CcSecurityFrameworkPanel *self)
+{
+  guint delay = UPDATER_TIMEOUT;
+
+  /* Poll less and less often while LSF keeps failing, with jitter so a
+   * fleet of desktops does not retry in lockstep. */
+  if (self->update_failures > 0)
+  {
+    delay = UPDATER_BACKOFF_BASE << MIN (self->update_failures - 1, 16);
+    delay = MIN (delay, UPDATER_BACKOFF_MAX);
+    delay = delay / 2 + g_random_int_range (0, delay / 2 + 1);
+  }
+
+  if (self->event_source_tag[SOURCE_FUNC_UPDATER])
+    g_source_remove (self->event_source_tag[SOURCE_FUNC_UPDATER]);
+  self->event_source_tag[SOURCE_FUNC_UPDATER] = g_timeout_add (delay, modules_state_timeout, self);
+}
+
+static void
+modules_state_updated (GObject      *source_object,
+                       GAsyncResult *result,
+                       gpointer      user_data)
+{
+  CcSecurityFrameworkPanel *self;
+  GError *error = NULL;
+  security_app *modules[APPS_MAX] = { NULL, };
+  int ret_num = -1;
+  char *ret;
+  gint64 start;
+  gint64 trace;
+
+  ret = cc_lsf_client_call_finish (CC_LSF_CLIENT (source_object), result, &error);
+  if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+  {
+    g_error_free (error);
+    return;
+  }
+  g_clear_error (&error);
+
+  start = g_get_monotonic_time ();
+  self = CC_SECURITY_FRAMEWORK_PANEL (user_data);
+  self->updating = FALSE;
+
+  if (ret)
+  {
+    self->update_failures = 0;
+    trace = cc_lsf_trace_begin ();
+    ret_num = resp_parser (ret, modules);
+    cc_lsf_trace_mark (trace, "Security framework", "Parse", "status, %d apps", ret_num);
+    g_free (ret);
+  }
+  else
+    self->update_failures++;
+  schedule_modules_state_update (self);
+
+  trace = cc_lsf_trace_begin ();
+  if (ret_num != -1)
+    set_apps (self, modules, ret_num);
+  set_modules_opacity (self);
+  cc_lsf_trace_mark (trace, "Security framework", "Update", "%d apps", self->apps_num);
+  self->updater_time = g_get_monotonic_time () - start;
+}
+
+static gboolean
+modules_state_updater (CcSecurityFrameworkPanel *self)
+{
+  if (!self->updating)
+  {
+    self->updating = TRUE;
+    dbus_message_sender (self, GET_STATUS, modules_state_updated);
+  }
 
   return TRUE;
 }
 
+/* Resident set size of the panel process in KiB, 0 if unknown. */
+static gulong
+get_rss_kb (void)
+{
+  gchar *contents = NULL;
+  gulong size = 0, resident = 0;
+
+  if (g_file_get_contents ("/proc/self/statm", &contents, NULL, NULL))
+  {
+    if (sscanf (contents, "%lu %lu", &size, &resident) != 2)
+      resident = 0;
+    g_free (contents);
+  }
+
+  return resident * (sysconf (_SC_PAGESIZE) / 1024);
+}
+
+/* The counters behind the overlay are kept all the time; only turning
+ * them into text, and anything that needs I/O, waits for the overlay. */
+static gboolean
+update_perf_overlay (gpointer user_data)
+{
+  CcSecurityFrameworkPanel *self = CC_SECURITY_FRAMEWORK_PANEL (user_data);
+  CcLsfClientStats stats;
+  CcLsfSceneStats ingest;
+  gint64 now = g_get_monotonic_time ();
+  gchar *text;
+
+  cc_lsf_client_get_stats (cc_lsf_client_get_default (), &stats);
+  cc_lsf_scene_reader_get_stats (self->log_reader, &ingest);
+  text = g_strdup_printf ("Frame\t%.1f ms (max %.1f ms)\n"
+                          "Events\t%.0f/s\n"
+                          "Backlog\t%" G_GOFFSET_FORMAT " bytes\n"
+                          "LSF\t%.1f ms (p99 %.1f ms)\n"
+                          "Updater\t%.1f ms\n"
+                          "RSS\t%lu KiB",
+                          self->presenter_time / 1000.0, self->presenter_max / 1000.0,
+                          (ingest.events - self->perf_events) * (double) G_USEC_PER_SEC /
+                          MAX (now - self->perf_reported, 1),
+                          cc_lsf_scene_reader_get_backlog (self->log_reader),
+                          stats.last_latency / 1000.0, stats.p99_latency / 1000.0,
+                          self->updater_time / 1000.0,
+                          get_rss_kb ());
+  gtk_label_set_text (GTK_LABEL (self->perf_label), text);
+  g_free (text);
+
+  self->perf_events = ingest.events;
+  self->perf_reported = now;
+  self->presenter_max = 0;
+
+  return G_SOURCE_CONTINUE;
+}
+
+static void
+toggle_perf_overlay (CcSecurityFrameworkPanel *self)
+{
+  CcLsfSceneStats ingest;
+
+  if (self->perf_source)
+  {
+    g_source_remove (self->perf_source);
+    self->perf_source = 0;
+    gtk_widget_hide (self->perf_label);
+    return;
+  }
+
+  cc_lsf_scene_reader_get_stats (self->log_reader, &ingest);
+  self->perf_events = ingest.events;
+  self->perf_reported = g_get_monotonic_time ();
+  update_perf_overlay (self);
+  self->perf_source = g_timeout_add (PERF_OVERLAY_INTERVAL, update_perf_overlay, self);
+  gtk_widget_show (self->perf_label);
+}
+
+static gboolean
+panel_key_pressed (GtkWidget   *widget,
+                   GdkEventKey *event,
+                   gpointer     user_data)
+{
+  GdkModifierType mods = event->state & gtk_accelerator_get_default_mod_mask ();
+
+  if (mods == (GDK_CONTROL_MASK | GDK_SHIFT_MASK) &&
+      gdk_keyval_to_upper (event->keyval) == PERF_OVERLAY_KEY)
+  {
+    toggle_perf_overlay (CC_SECURITY_FRAMEWORK_PANEL (widget));
+    return GDK_EVENT_STOP;
+  }
+
+  return GDK_EVENT_PROPAGATE;
+}
+
 static const char *
 cc_security_framework_panel_get_help_uri (CcPanel *self)
 {
@@ -1477,18 +1699,47 @@ cc_security_framework_panel_dispose (GObject *object)
   CcSecurityFrameworkPanel *self = CC_SECURITY_FRAMEWORK_PANEL (object);
   int i;
 
-  if (self->event_cnt)
+  if (self->cancellable)
+  {
+    g_cancellable_cancel (self->cancellable);
+    g_clear_object (&self->cancellable);
+  }
+
+  if (self->reachable_handler)
+  {
+    g_signal_handler_disconnect (cc_lsf_client_get_default (), self->reachable_handler);
+    self->reachable_handler = 0;
+  }
+
+  if (self->perf_source)
   {
-    for (i = 0; i < self->event_cnt; i++)
+    g_source_remove (self->perf_source);
+    self->perf_source = 0;
+  }
+
+  for (i = 0; i < SOURCE_FUNC_NUM; i++)
+  {
+    if (self->event_source_tag[i])
       g_source_remove (self->event_source_tag[i]);
-    self->event_cnt = 0;
+    self->event_source_tag[i] = 0;
+  }
+  self->event_cnt = 0;
+
+  for (i = 0; i < self->apps_num; i++)
+  {
+    free_app (apps[i]);
+    apps[i] = NULL;
   }
+  self->apps_num = 0;
 
-  if (self->fp != NULL)
+  if (self->full_log)
   {
-    fclose (self->fp);
-    self->fp = NULL;
+    g_string_free (self->full_log, TRUE);
+    self->full_log = NULL;
   }
+  g_clear_pointer (&self->from_log, g_free);
+  g_clear_pointer (&self->log_reader, cc_lsf_scene_reader_free);
+  g_clear_pointer (&self->graph, cc_security_topology_free);
 
   G_OBJECT_CLASS (cc_security_framework_panel_parent_class)->dispose (object);
 }
@@ -1500,7 +1751,7 @@ cc_security_framework_panel_constructed (GObject *object)
 
   self->event_source_tag[SOURCE_FUNC_PRESENTER] = g_timeout_add (PRESENTER_TIMEOUT, (GSourceFunc) scene_presenter, (gpointer) self);
   self->event_cnt++;
-  self->event_source_tag[SOURCE_FUNC_UPDATER] = g_timeout_add (UPDATER_TIMEOUT, (GSourceFunc) modules_state_updater, (gpointer) self);
+  schedule_modules_state_update (self);
   self->event_cnt++;
 }
 
@@ -1514,220 +1765,276 @@ cc_security_framework_panel_class_init (CcSecurityFrameworkPanelClass *klass)
   object_class->constructed = cc_security_framework_panel_constructed;
 
   gtk_widget_class_set_template_from_resource (widget_class, "/org/gnome/control-center/security-framework/security-framework.ui");
-  gtk_widget_class_bind_template_child (widget_class, CcSecurityFrameworkPanel, ghub_section);
-  gtk_widget_class_bind_template_child (widget_class, CcSecurityFrameworkPanel, gauth_section);
-  gtk_widget_class_bind_template_child (widget_class, CcSecurityFrameworkPanel, apps_section);
-  gtk_widget_class_bind_template_child (widget_class, CcSecurityFrameworkPanel, gpms_button);
-  gtk_widget_class_bind_template_child (widget_class, CcSecurityFrameworkPanel, gctrl_button);
-  gtk_widget_class_bind_template_child (widget_class, CcSecurityFrameworkPanel, agent_button);
-  gtk_widget_class_bind_template_child (widget_class, CcSecurityFrameworkPanel, ghub_cc);
-  gtk_widget_class_bind_template_child (widget_class, CcSecurityFrameworkPanel, ghub_gauth);
-  gtk_widget_class_bind_template_child (widget_class, CcSecurityFrameworkPanel, ghub_gctrl);
-  gtk_widget_class_bind_template_child (widget_class, CcSecurityFrameworkPanel, ghub_agent);
-  gtk_widget_class_bind_template_child (widget_class, CcSecurityFrameworkPanel, ghub_apps);
-  gtk_widget_class_bind_template_child (widget_class, CcSecurityFrameworkPanel, agent_gpms);
-  gtk_widget_class_bind_template_child (widget_class, CcSecurityFrameworkPanel, d1);
-  gtk_widget_class_bind_template_child (widget_class, CcSecurityFrameworkPanel, d2);
-  gtk_widget_class_bind_template_child (widget_class, CcSecurityFrameworkPanel, d3);
-  gtk_widget_class_bind_template_child (widget_class, CcSecurityFrameworkPanel, d4);
-  gtk_widget_class_bind_template_child (widget_class, CcSecurityFrameworkPanel, d5);
-  gtk_widget_class_bind_template_child (widget_class, CcSecurityFrameworkPanel, d6);
-  gtk_widget_class_bind_template_child (widget_class, CcSecurityFrameworkPanel, d7);
-  gtk_widget_class_bind_template_child (widget_class, CcSecurityFrameworkPanel, d8);
-  gtk_widget_class_bind_template_child (widget_class, CcSecurityFrameworkPanel, cc_image);
-  gtk_widget_class_bind_template_child (widget_class, CcSecurityFrameworkPanel, ghub_image);
-  gtk_widget_class_bind_template_child (widget_class, CcSecurityFrameworkPanel, gauth_image);
-  gtk_widget_class_bind_template_child (widget_class, CcSecurityFrameworkPanel, gctrl_image);
-  gtk_widget_class_bind_template_child (widget_class, CcSecurityFrameworkPanel, gpms_image);
-  gtk_widget_class_bind_template_child (widget_class, CcSecurityFrameworkPanel, agent_image);
-  gtk_widget_class_bind_template_child (widget_class, CcSecurityFrameworkPanel, apps_view);
+  gtk_widget_class_bind_template_child (widget_class, CcSecurityFrameworkPanel, scene_overlay);
+  gtk_widget_class_bind_template_child (widget_class, CcSecurityFrameworkPanel, topology_area);
   gtk_widget_class_bind_template_child (widget_class, CcSecurityFrameworkPanel, apps_list);
   gtk_widget_class_bind_template_child (widget_class, CcSecurityFrameworkPanel, log_button);
   gtk_widget_class_bind_template_child (widget_class, CcSecurityFrameworkPanel, security_framework_notebook);
   gtk_widget_class_bind_template_child (widget_class, CcSecurityFrameworkPanel, no_security_framework_label);
+  gtk_widget_class_bind_template_child (widget_class, CcSecurityFrameworkPanel, perf_label);
 }
 
 static void
 panel_value_init (CcSecurityFrameworkPanel *self)
 {
-  GDateTime *local_time;
+  gchar *path;
 
-  self->fp = NULL;
   self->policy_reload_flag = FALSE;
   self->event_cnt = 0;
   self->log_start = 0;
   self->log_end = -1;
   self->log_cnt = 0;
   self->scene = SCENE_IDLE;
+  self->active_edge = -1;
+  self->lsf_state = LSF_STATE_READY;
+  self->update_failures = 0;
   self->init_num = 0;
   self->apps_num = 0;
-  self->full_log = _("\n\t*** Security Framework Panel Activated. ***\n\n");
-  local_time = g_date_time_new_now_local ();
-  self->tailing_file = g_strconcat (LOG_DIRECTORY, LOG_FILE_PREFIX, "-", g_date_time_format (local_time, "%F"), ".log", NULL);
-  g_date_time_unref (local_time);
+  self->full_log = g_string_new (_("\n\t*** Security Framework Panel Activated. ***\n\n"));
+  path = cc_lsf_log_get_path ();
+  self->log_reader = cc_lsf_scene_reader_new (path, FALSE, get_app_display_name, self);
+  g_free (path);
 }
 
-static void
-cc_security_framework_panel_init (CcSecurityFrameworkPanel *self)
+static int
+read_lsf_conf (void)
 {
-  int module;
-  GtkWidget *event_box;
-  PangoAttrList *pg_attr_list;
-  PangoAttribute *pg_attr;
-  char *ret;
-  int r, i, j, k, d;
-  FILE* fp = NULL;
+  FILE *fp = NULL;
   char buf[255] = {0, };
   char key[255] = {0, };
   char val[255] = {0, };
-  gboolean deactivated = TRUE;
+  int i, j, k, d;
+  int state = LSF_STATE_DEACTIVATED;
 
-  g_resources_register (cc_security_framework_get_resource ());
+  fp = fopen (LSF_CONF, "r");
+  if (fp == NULL)
+    return LSF_STATE_NOT_FOUND;
 
-  gtk_widget_init_template (GTK_WIDGET (self));
-  panel_value_init (self);
-
-  if (access (LSF_CONF, R_OK))
-    gtk_notebook_set_current_page (GTK_NOTEBOOK (self->security_framework_notebook), LSF_NOT_FOUND_PAGE);
-  else
+  while (fgets (buf, sizeof (buf), fp))
   {
-    fp = fopen (LSF_CONF, "r");
-    while (fgets (buf, sizeof (buf), fp))
+    for (i=j=k=d=0; buf[i]; i++)
     {
-      for (i=j=k=d=0; buf[i]; i++)
-      {
-        if (buf[i] == ' ' || buf[i] == '\n')
-          continue;
-
-        if (d)
-          val[k++] = buf[i];
-        else if (buf[i] == '=')
-          d = TRUE;
-        else
-          key[j++] = buf[i];
-      }
-      key[j]=val[k]='\0';
-      if (!d)
+      if (buf[i] == ' ' || buf[i] == '\n')
         continue;
-      
-      if (strcmp (key, "control_center_use") == 0)
-      {
-        if (strcmp (val, "yes") == 0)
-          deactivated = FALSE;
-        break;
-      }
+
+      if (d)
+        val[k++] = buf[i];
+      else if (buf[i] == '=')
+        d = TRUE;
+      else
+        key[j++] = buf[i];
     }
-    fclose (fp);
-    if (deactivated)
+    key[j]=val[k]='\0';
+    if (!d)
+      continue;
+
+    if (strcmp (key, "control_center_use") == 0)
     {
-      gtk_notebook_set_current_page (GTK_NOTEBOOK (self->security_framework_notebook), LSF_NOT_FOUND_PAGE);
-      gtk_label_set_text (GTK_LABEL (self->no_security_framework_label), _("Security Framework Panel Deactivated."));
+      if (strcmp (val, "yes") == 0)
+        state = LSF_STATE_READY;
+      break;
     }
   }
+  fclose (fp);
+
+  return state;
+}
+
+static void
+lsf_startup_thread (GTask        *task,
+                    gpointer      source_object,
+                    gpointer      task_data,
+                    GCancellable *cancellable)
+{
+  int state;
+
+  state = read_lsf_conf ();
+  if (state == LSF_STATE_READY && !cc_lsf_credentials_ensure ())
+    state = LSF_STATE_AUTH_FAILED;
+
+  g_task_return_int (task, state);
+}
+
+static void
+lsf_config_received (GObject      *source_object,
+                     GAsyncResult *result,
+                     gpointer      user_data)
+{
+  CcSecurityFrameworkPanel *self;
+  GError *error = NULL;
+  char *ret;
+  gint64 trace;
+
+  ret = cc_lsf_client_call_finish (CC_LSF_CLIENT (source_object), result, &error);
+  if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+  {
+    g_error_free (error);
+    return;
+  }
+  g_clear_error (&error);
 
-  if (!deactivated)
+  self = CC_SECURITY_FRAMEWORK_PANEL (user_data);
+  if (ret)
   {
-    gtk_notebook_set_current_page (GTK_NOTEBOOK (self->security_framework_notebook), LSF_PAGE);
-    lsf_user_data_t app_data;
-    r = lsf_auth (&app_data, CC_PASSPHRASE);
-    if (r == LSF_AUTH_STAT_OK)
-    {
-      lsf_panel_symm_key = g_strdup (app_data.symm_key);
-      lsf_panel_access_token = g_strdup (app_data.access_token);
-      ret = dbus_message_sender (GINT_TO_POINTER (GET_CONFIG));
-      self->topology = get_topology (ret);
-    }
-    modules_state_updater (self);
-    draw_lines (self);
+    trace = cc_lsf_trace_begin ();
+    self->topology = get_topology (ret);
+    self->topology_known = TRUE;
+    cc_lsf_trace_mark (trace, "Security framework", "Parse", "topology");
+    g_free (ret);
+  }
+  set_menu_items (self, GCTRL);
+}
 
-    self->fp = fopen (self->tailing_file, "r");
-    if (self->fp != NULL)
-    {
-      fseek (self->fp, 0, SEEK_END);
-      self->fpos = ftell (self->fp);
-    }
+static void
+update_lsf_page (CcSecurityFrameworkPanel *self)
+{
+  GtkNotebook *notebook = GTK_NOTEBOOK (self->security_framework_notebook);
+  GtkLabel *label = GTK_LABEL (self->no_security_framework_label);
 
-    self->agent_menu = gtk_menu_new ();
-    set_menu_items (self, AGENT);
+  switch (self->lsf_state)
+  {
+    case LSF_STATE_NOT_FOUND:
+      gtk_notebook_set_current_page (notebook, LSF_NOT_FOUND_PAGE);
+      gtk_label_set_text (label, _("Security Framework not installed."));
+      break;
+    case LSF_STATE_DEACTIVATED:
+      gtk_notebook_set_current_page (notebook, LSF_NOT_FOUND_PAGE);
+      gtk_label_set_text (label, _("Security Framework Panel Deactivated."));
+      break;
+    default:
+      if (cc_lsf_client_is_reachable (cc_lsf_client_get_default ()))
+        gtk_notebook_set_current_page (notebook, LSF_PAGE);
+      else
+      {
+        gtk_notebook_set_current_page (notebook, LSF_NOT_FOUND_PAGE);
+        gtk_label_set_text (label, _("Security Framework unreachable."));
+      }
+      break;
+  }
+}
 
-    self->gctrl_menu = gtk_menu_new ();
-    set_menu_items (self, GCTRL);
+static void
+lsf_reachable_changed (GObject    *object,
+                       GParamSpec *pspec,
+                       gpointer    user_data)
+{
+  update_lsf_page (CC_SECURITY_FRAMEWORK_PANEL (user_data));
+}
 
-    self->log_label = gtk_label_new ("");
+static void
+lsf_startup_finished (GObject      *source_object,
+                      GAsyncResult *result,
+                      gpointer      user_data)
+{
+  CcSecurityFrameworkPanel *self;
+  GError *error = NULL;
+  int state;
 
-    g_signal_connect (G_OBJECT (self->d1),
-                      "draw",
-                      G_CALLBACK (draw_vertical_bar),
-                      self);
-    g_signal_connect (G_OBJECT (self->d2),
-                      "draw",
-                      G_CALLBACK (draw_vertical_bar),
-                      self);
-    g_signal_connect (G_OBJECT (self->d3),
-                      "draw",
-                      G_CALLBACK (draw_vertical_bar),
-                      self);
-    g_signal_connect (G_OBJECT (self->d4),
-                      "draw",
-                      G_CALLBACK (draw_vertical_bar),
-                      self);
-    g_signal_connect (G_OBJECT (self->d5),
-                      "draw",
-                      G_CALLBACK (draw_vertical_bar),
-                      self);
-    g_signal_connect (G_OBJECT (self->d6),
-                      "draw",
-                      G_CALLBACK (draw_vertical_bar),
-                      self);
-    g_signal_connect (G_OBJECT (self->d7),
-                      "draw",
-                      G_CALLBACK (draw_vertical_bar),
-                      self);
-    g_signal_connect (G_OBJECT (self->d8),
-                      "draw",
-                      G_CALLBACK (draw_vertical_bar),
-                      self);
-    g_signal_connect (G_OBJECT (self->ghub_cc),
-                      "draw",
-                      G_CALLBACK (draw_conn_ghub_cc),
-                      self);
-    g_signal_connect (G_OBJECT (self->ghub_gauth),
-                      "draw",
-                      G_CALLBACK (draw_conn_ghub_gauth),
-                      self);
-    g_signal_connect (G_OBJECT (self->ghub_gctrl),
-                      "draw",
-                      G_CALLBACK (draw_conn_ghub_gctrl),
-                      self);
-    g_signal_connect (G_OBJECT (self->ghub_apps),
-                      "draw",
-                      G_CALLBACK (draw_conn_ghub_apps),
-                      self);
-    g_signal_connect (G_OBJECT (self->agent_gpms),
-                      "draw",
-                      G_CALLBACK (draw_conn_agent_gpms),
-                      self);
-    g_signal_connect (G_OBJECT (self->ghub_agent),
-                      "draw",
-                      G_CALLBACK (draw_conn_ghub_agent),
-                      self);
-    g_signal_connect (G_OBJECT (self->gpms_button),
-                      "button-press-event",
-                      G_CALLBACK (gpms_cell_clicked),
-                      self);
-    g_signal_connect (G_OBJECT (self->agent_button),
-                      "button-press-event",
-                      G_CALLBACK (agent_cell_clicked),
-                      self);
-    g_signal_connect (G_OBJECT (self->gctrl_button),
-                      "button-press-event",
-                      G_CALLBACK (gctrl_cell_clicked),
-                      self);
-    g_signal_connect (G_OBJECT (self->log_button),
-                      "clicked",
-                      G_CALLBACK (log_button_clicked),
-                      self);
+  state = g_task_propagate_int (G_TASK (result), &error);
+  if (error)
+  {
+    g_error_free (error);
+    return;
   }
+
+  self = CC_SECURITY_FRAMEWORK_PANEL (source_object);
+  self->lsf_state = state;
+  update_lsf_page (self);
+
+  switch (state)
+  {
+    case LSF_STATE_AUTH_FAILED:
+      set_menu_items (self, GCTRL);
+      modules_state_updater (self);
+      break;
+    case LSF_STATE_READY:
+      /* Configuration and module status are independent, fetch them in parallel. */
+      dbus_message_sender (self, GET_CONFIG, lsf_config_received);
+      modules_state_updater (self);
+      break;
+  }
+}
+
+static gboolean
+first_frame_drawn (GtkWidget *widget,
+                   cairo_t   *cr,
+                   gpointer   user_data)
+{
+  CcSecurityFrameworkPanel *self = CC_SECURITY_FRAMEWORK_PANEL (widget);
+  gint64 elapsed = (g_get_monotonic_time () - self->init_time) / 1000;
+
+  g_debug ("Security framework panel: first frame after %" G_GINT64_FORMAT " ms (target %d ms)",
+           elapsed, FIRST_FRAME_TARGET);
+
+  g_signal_handler_disconnect (widget, self->first_frame_handler);
+  self->first_frame_handler = 0;
+
+  return FALSE;
+}
+
+static void
+cc_security_framework_panel_init (CcSecurityFrameworkPanel *self)
+{
+  GTask *task;
+
+  self->init_time = g_get_monotonic_time ();
+  g_resources_register (cc_security_framework_get_resource ());
+
+  gtk_widget_init_template (GTK_WIDGET (self));
+  panel_value_init (self);
+  build_topology (self);
+
+  /* Show the topology right away with every module dimmed, the LSF
+   * configuration, authentication and module status arrive later. */
+  update_lsf_page (self);
+  set_modules_opacity (self);
+
+  self->agent_menu = gtk_menu_new ();
+  set_menu_items (self, AGENT);
+
+  self->gctrl_menu = gtk_menu_new ();
+  add_cell_buttons (self);
+
+  /* A module is told apart as app or daemon by whether it installed a
+   * panel, which may change while the panel is open. */
+  g_signal_connect_object (cc_security_apps_registry_get_default (), "app-added",
+                           G_CALLBACK (installed_apps_changed), self, G_CONNECT_SWAPPED);
+  g_signal_connect_object (cc_security_apps_registry_get_default (), "app-removed",
+                           G_CALLBACK (installed_apps_changed), self, G_CONNECT_SWAPPED);
+
+  self->log_label = gtk_label_new ("");
+
+  g_signal_connect (G_OBJECT (self->topology_area),
+                    "draw",
+                    G_CALLBACK (draw_topology),
+                    self);
+  g_signal_connect (G_OBJECT (self->topology_area),
+                    "notify::scale-factor",
+                    G_CALLBACK (topology_scale_changed),
+                    self);
+  g_signal_connect (G_OBJECT (self->log_button),
+                    "clicked",
+                    G_CALLBACK (log_button_clicked),
+                    self);
+  g_signal_connect (G_OBJECT (self),
+                    "key-press-event",
+                    G_CALLBACK (panel_key_pressed),
+                    NULL);
+
+  self->first_frame_handler = g_signal_connect_after (G_OBJECT (self),
+                                                      "draw",
+                                                      G_CALLBACK (first_frame_drawn),
+                                                      NULL);
+
+  self->reachable_handler = g_signal_connect (cc_lsf_client_get_default (),
+                                              "notify::reachable",
+                                              G_CALLBACK (lsf_reachable_changed),
+                                              self);
+
+  self->cancellable = g_cancellable_new ();
+  task = g_task_new (self, self->cancellable, lsf_startup_finished, NULL);
+  g_task_run_in_thread (task, lsf_startup_thread);
+  g_object_unref (task);
 }
 
 GtkWidget *
@@ -23,6 +23,13 @@
 #include <lsf/lsf-auth.h>
 #include <lsf/lsf-dbus.h>
 
+#include "cc-lsf-client.h"
+#include "cc-lsf-credentials.h"
+#include "cc-lsf-log.h"
+#include "cc-lsf-scene.h"
+#include "cc-lsf-trace.h"
+#include "cc-security-apps-registry.h"
+
 G_BEGIN_DECLS
 
 #define CC_TYPE_SECURITY_FRAMEWORK_PANEL (cc_security_framework_panel_get_type ())
@@ -40,99 +47,88 @@ G_DECLARE_FINAL_TYPE (CcSecurityFrameworkPanel, cc_security_framework_panel, CC,
 #define XPOS                    0
 #define YPOS                    1
 
-#define VT                     15
-#define HT                     20
-
 #define STARTING_BLINK_CNT      5
-#define ENDING_BLINK_CNT       15
 #define MOVING_CNT              6
 #define KEY_EXCHANGE_FIN        3
 
 #define SCENE_CNT              17
 #define SCENE_END              -1
 
-#define DEFAULT_BUF_SIZE     4096
-#define PARAM_BUF            1024
-
 #define NORM                    0
 #define REV                     1
 #define LOG_BUF                10
 #define PRESENTER_TIMEOUT      50
 #define MINUTE              60000
 #define UPDATER_TIMEOUT  1*MINUTE
+#define UPDATER_BACKOFF_BASE  5000
+#define UPDATER_BACKOFF_MAX   5*MINUTE
+#define LSF_REQUEST_TIMEOUT   5000
+#define FIRST_FRAME_TARGET    100
+
+/* Ctrl+Shift+P shows live timings over the topology, refreshed every
+ * PERF_OVERLAY_INTERVAL milliseconds while visible. */
+#define PERF_OVERLAY_KEY      GDK_KEY_P
+#define PERF_OVERLAY_INTERVAL 1000
 
 #define RESOURCE_DIR     "/org/gnome/control-center/security-framework/resources"
-#define CC_IMG           RESOURCE_DIR"/cc-image.svg"
-#define GHUB_IMG         RESOURCE_DIR"/ghub-image.svg"
-#define GAUTH_IMG        RESOURCE_DIR"/gauth-image.svg"
-#define GCTRL_IMG        RESOURCE_DIR"/gctrl-image.svg"
-#define AGENT_IMG        RESOURCE_DIR"/agent-image.svg"
-#define GPMS_IMG         RESOURCE_DIR"/gpms-image.svg"
-#define APPS_IMG         RESOURCE_DIR"/apps-image.svg"
-
-#define CC_DBUS          "kr.gooroom.controlcenter"
+
+/* Module artwork, rendered to RESOURCE_DIR/<scale>x/<name>.png at build
+ * time, see cc_security_topology_load_icon(). */
+#define CC_IMG           "cc-image"
+#define GHUB_IMG         "ghub-image"
+#define GAUTH_IMG        "gauth-image"
+#define GCTRL_IMG        "gctrl-image"
+#define AGENT_IMG        "agent-image"
+#define GPMS_IMG         "gpms-image"
+#define APPS_IMG         "apps-image"
+#define APPS_HUB_IMG     "apps-hub-image"
+
+/* LSF daemons the panel has no artwork of their own for. */
+#define DAEMON_IMG       GCTRL_IMG
+
+#define CC_DBUS          CC_LSF_DBUS_NAME
 #define GHUB_DBUS        "kr.gooroom.ghub"
 #define GAUTH_DBUS       "kr.gooroom.gauth"
 #define GCTRL_DBUS       "kr.gooroom.gcontroller"
 #define AGENT_DBUS       "kr.gooroom.agent"
 
 #define GPMS_NAME        "gpms"
-#define LOG_DIRECTORY    "/var/log/lsf/"
-#define LOG_FILE_PREFIX  "message"
 
 #define LSF_CONF         "/etc/gooroom/lsf/lsf.conf"
 #define GCSR_CONF        "/etc/gooroom/gooroom-client-server-register/gcsr.conf"
 #define V3_DOMAIN        "http://localhost:88"
 
-#define CC_PASSPHRASE      "n6x6myibEAvfN9vIDDPQi+iCoE7yTuHP//eC195+g7w="
-
-gchar *lsf_panel_symm_key;
-gchar *lsf_panel_access_token;
-
 enum
 {
-  SCENE_IDLE,
-  SCENE_METHOD_CALL,
-  SCENE_METHOD_CALL_REV,
-  SCENE_POLICY_RELOAD,
-  SCENE_NUM
+  SCENE_IDLE            = CC_LSF_SCENE_IDLE,
+  SCENE_METHOD_CALL     = CC_LSF_SCENE_METHOD_CALL,
+  SCENE_METHOD_CALL_REV = CC_LSF_SCENE_METHOD_CALL_REV,
+  SCENE_POLICY_RELOAD   = CC_LSF_SCENE_POLICY_RELOAD,
+  SCENE_NUM             = CC_LSF_SCENE_NUM
 };
 
 enum
 {
-  CC,
-  GHUB,
-  GAUTH,
-  GCTRL,
-  AGENT,
-  GPMS,
-  APPS,
-  CELL_NUM
+  KEYFRAME_START,
+  KEYFRAME_SOURCE_ON,
+  KEYFRAME_SOURCE_OFF,
+  KEYFRAME_EDGE,
+  KEYFRAME_TARGET_ON,
+  KEYFRAME_TARGET_OFF,
+  KEYFRAME_TARGET_SETTLE,
+  KEYFRAME_END
 };
 
-char *module_name[CELL_NUM] = { "CC",
-                                "GHUB",
-                                "GAUTH",
-                                "GCTRL",
-                                "AGENT",
-                                "GPMS",
-                                "APPS" };
-
-char *lsf_dbus_name[] = { "kr.gooroom.controlcenter",
-                          "kr.gooroom.ghub",
-                          "kr.gooroom.gauth",
-                          "kr.gooroom.gcontroller",
-                          "kr.gooroom.agent" };
-
 enum
 {
-  DIRECTION_GHUB_CC,
-  DIRECTION_GHUB_GAUTH,
-  DIRECTION_GHUB_AGENT,
-  DIRECTION_GHUB_GCTRL,
-  DIRECTION_AGENT_GPMS,
-  DIRECTION_GHUB_APPS,
-  DIRECTION_NUM
+  CC       = CC_LSF_CELL_CC,
+  GHUB     = CC_LSF_CELL_GHUB,
+  GAUTH    = CC_LSF_CELL_GAUTH,
+  GCTRL    = CC_LSF_CELL_GCTRL,
+  AGENT    = CC_LSF_CELL_AGENT,
+  GPMS     = CC_LSF_CELL_GPMS,
+  APPS     = CC_LSF_CELL_APPS,
+  CELL_NUM = CC_LSF_CELL_NUM
 };
 
 enum
@@ -161,17 +157,10 @@ enum
 
 enum
 {
-  DMSG_SEQ,
-  DMSG_DIRECTION,
-  DMSG_METHOD,
-  DMSG_ABS,
-  DMSG_GLYPH,
-  DMSG_FROM,
-  DMSG_TO,
-  DMSG_FUNC,
-  DMSG_ERR,
-  DMSG_PAYLOAD,
-  DMSG_NUM
+  LSF_STATE_NOT_FOUND,
+  LSF_STATE_DEACTIVATED,
+  LSF_STATE_AUTH_FAILED,
+  LSF_STATE_READY
 };
 
 enum
@@ -192,6 +181,7 @@ typedef struct _security_app
   gboolean   set;
   int        cell_ref;
   int        app_idx;
+  gdouble    opacity;
 } security_app;
 
 GtkWidget *cc_security_framework_panel_new (void);
@@ -0,0 +1,396 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/*
+ * Copyright (C) 2020 gooroom <gooroom@gooroom.kr>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+
+
+#include <math.h>
+
+#include "cc-security-topology.h"
+
+/*
+ * The modules of the security framework laid out on a grid of cells, each
+ * connected to its parent. Node geometry, connection dots and separators
+ * are computed once for a given size and reused by every frame and by
+ * the widgets laid over the nodes until the size or the set of nodes
+ * changes. Changes to a node or a connection add its area to a damage
+ * region, which the canvas takes once per frame to repaint only that.
+ */
+
+struct _CcSecurityTopology
+{
+  gchar     *resource_dir;
+  gint       scale;
+  GPtrArray *nodes;
+  GArray    *separator_columns;
+  GArray    *separators;
+  gint       n_columns;
+  gint       n_rows;
+  gint       width;
+  gint       height;
+  gboolean   valid;
+  cairo_region_t *damage;
+};
+
+static void
+node_free (CcTopologyNode *node)
+{
+  g_free (node->dbus_name);
+  g_free (node->label);
+  g_free (node->image);
+  g_clear_pointer (&node->icon, cairo_surface_destroy);
+  g_free (node);
+}
+
+/* Node images are looked up in resource_dir, rendered for scale. */
+CcSecurityTopology *
+cc_security_topology_new (const char *resource_dir,
+                          gint        scale)
+{
+  CcSecurityTopology *self = g_new0 (CcSecurityTopology, 1);
+
+  self->resource_dir = g_strdup (resource_dir);
+  self->scale = scale;
+  self->nodes = g_ptr_array_new_with_free_func ((GDestroyNotify) node_free);
+  self->separator_columns = g_array_new (FALSE, FALSE, sizeof (gint));
+  self->separators = g_array_new (FALSE, TRUE, sizeof (gdouble));
+  self->damage = cairo_region_create ();
+
+  return self;
+}
+
+void
+cc_security_topology_free (CcSecurityTopology *self)
+{
+  g_ptr_array_unref (self->nodes);
+  g_array_unref (self->separator_columns);
+  g_array_unref (self->separators);
+  cairo_region_destroy (self->damage);
+  g_free (self->resource_dir);
+  g_free (self);
+}
+
+static gboolean
+cell_taken (CcSecurityTopology *self,
+            gint                column,
+            gint                row)
+{
+  CcTopologyNode *node;
+  guint i;
+
+  for (i = 0; i < self->nodes->len; i++)
+  {
+    node = g_ptr_array_index (self->nodes, i);
+    if (node->column == column && node->row == row)
+      return TRUE;
+  }
+
+  return FALSE;
+}
+
+/* A negative row takes the first free cell of the column. Returns the
+ * index of the node, which stays valid until a node before it is
+ * removed. */
+gint
+cc_security_topology_add_node (CcSecurityTopology *self,
+                               const char         *dbus_name,
+                               const char         *label,
+                               const char         *image,
+                               gint                column,
+                               gint                row,
+                               gint                parent)
+{
+  CcTopologyNode *node;
+
+  if (row < 0)
+    for (row = 0; cell_taken (self, column, row); row++);
+
+  node = g_new0 (CcTopologyNode, 1);
+  node->dbus_name = g_strdup (dbus_name);
+  node->label = g_strdup (label);
+  node->image = g_strdup (image);
+  node->column = column;
+  node->row = row;
+  node->parent = parent;
+  node->opacity = 1.0;
+  node->blink = 1.0;
+  if (image)
+    node->icon = cc_security_topology_load_icon (self->resource_dir, image, self->scale);
+  g_ptr_array_add (self->nodes, node);
+
+  self->n_columns = MAX (self->n_columns, column + 1);
+  self->n_rows = MAX (self->n_rows, row + 1);
+  self->valid = FALSE;
+
+  return self->nodes->len - 1;
+}
+
+/* Nodes after the removed one move down one index, and a node that was
+ * connected to it is left unconnected. The grid shrinks to what is
+ * still taken. */
+void
+cc_security_topology_remove_node (CcSecurityTopology *self,
+                                  guint               index)
+{
+  CcTopologyNode *node;
+  guint i;
+
+  g_return_if_fail (index < self->nodes->len);
+
+  g_ptr_array_remove_index (self->nodes, index);
+
+  self->n_columns = 0;
+  self->n_rows = 0;
+  for (i = 0; i < self->nodes->len; i++)
+  {
+    node = g_ptr_array_index (self->nodes, i);
+    if (node->parent == (gint) index)
+      node->parent = -1;
+    else if (node->parent > (gint) index)
+      node->parent--;
+    self->n_columns = MAX (self->n_columns, node->column + 1);
+    self->n_rows = MAX (self->n_rows, node->row + 1);
+  }
+  for (i = 0; i < self->separator_columns->len; i++)
+    self->n_columns = MAX (self->n_columns, g_array_index (self->separator_columns, gint, i) + 1);
+  self->valid = FALSE;
+}
+
+/* A dashed line down the middle of a column, between two layers. */
+void
+cc_security_topology_add_separator (CcSecurityTopology *self,
+                                    gint                column)
+{
+  g_array_append_val (self->separator_columns, column);
+  self->n_columns = MAX (self->n_columns, column + 1);
+  self->valid = FALSE;
+}
+
+/* Loads every node image again for a new scale factor. The logical size
+ * of the images, and so the layout, stays the same. */
+void
+cc_security_topology_set_scale (CcSecurityTopology *self,
+                                gint                scale)
+{
+  CcTopologyNode *node;
+  guint i;
+
+  if (self->scale == scale)
+    return;
+
+  self->scale = scale;
+  for (i = 0; i < self->nodes->len; i++)
+  {
+    node = g_ptr_array_index (self->nodes, i);
+    if (!node->image)
+      continue;
+    g_clear_pointer (&node->icon, cairo_surface_destroy);
+    node->icon = cc_security_topology_load_icon (self->resource_dir, node->image, scale);
+  }
+}
+
+guint
+cc_security_topology_get_n_nodes (CcSecurityTopology *self)
+{
+  return self->nodes->len;
+}
+
+CcTopologyNode *
+cc_security_topology_get_node (CcSecurityTopology *self,
+                               guint               index)
+{
+  g_return_val_if_fail (index < self->nodes->len, NULL);
+
+  return g_ptr_array_index (self->nodes, index);
+}
+
+void
+cc_security_topology_get_size (CcSecurityTopology *self,
+                               gint               *width,
+                               gint               *height)
+{
+  *width = self->n_columns * CC_TOPOLOGY_CELL_WIDTH;
+  *height = self->n_rows * CC_TOPOLOGY_CELL_HEIGHT;
+}
+
+/* Returns TRUE if the geometry had to be computed again. */
+gboolean
+cc_security_topology_layout (CcSecurityTopology *self,
+                             gint                width,
+                             gint                height)
+{
+  CcTopologyNode *node;
+  CcTopologyNode *parent;
+  gdouble cell_width;
+  gdouble cell_height;
+  gdouble dx, dy, length;
+  gdouble x, x_end;
+  gdouble y_end;
+  guint i;
+
+  if (self->valid && self->width == width && self->height == height)
+    return FALSE;
+
+  self->width = width;
+  self->height = height;
+  self->valid = TRUE;
+  if (self->n_columns == 0 || self->n_rows == 0)
+    return TRUE;
+
+  cell_width = (gdouble) width / self->n_columns;
+  cell_height = (gdouble) height / self->n_rows;
+
+  for (i = 0; i < self->nodes->len; i++)
+  {
+    node = g_ptr_array_index (self->nodes, i);
+    node->rect.x = floor (node->column * cell_width);
+    node->rect.y = floor (node->row * cell_height);
+    node->rect.width = floor ((node->column + 1) * cell_width) - node->rect.x;
+    node->rect.height = floor ((node->row + 1) * cell_height) - node->rect.y;
+    node->ink_rect = node->rect;
+  }
+
+  /* The dots of a connection are centred between the two cells and run
+   * from the parent towards the child. */
+  for (i = 0; i < self->nodes->len; i++)
+  {
+    node = g_ptr_array_index (self->nodes, i);
+    if (node->parent < 0)
+      continue;
+
+    parent = g_ptr_array_index (self->nodes, node->parent);
+    dx = (node->column - parent->column) * cell_width;
+    dy = (node->row - parent->row) * cell_height;
+    length = MAX (sqrt (dx * dx + dy * dy), 1);
+    node->dot_dx = dx / length * CC_TOPOLOGY_DOT_SPACING_X;
+    node->dot_dy = dy / length * CC_TOPOLOGY_DOT_SPACING_Y;
+    node->dot_x = (node->column + parent->column + 1) * cell_width / 2 -
+                  node->dot_dx * (CC_TOPOLOGY_DOTS - 1) / 2;
+    node->dot_y = (node->row + parent->row + 1) * cell_height / 2 -
+                  node->dot_dy * (CC_TOPOLOGY_DOTS - 1) / 2;
+
+    x_end = node->dot_x + node->dot_dx * (CC_TOPOLOGY_DOTS - 1);
+    y_end = node->dot_y + node->dot_dy * (CC_TOPOLOGY_DOTS - 1);
+    node->edge_rect.x = floor (MIN (node->dot_x, x_end) - CC_TOPOLOGY_DOT_RADIUS);
+    node->edge_rect.y = floor (MIN (node->dot_y, y_end) - CC_TOPOLOGY_DOT_RADIUS);
+    node->edge_rect.width = ceil (MAX (node->dot_x, x_end) + CC_TOPOLOGY_DOT_RADIUS) -
+                            node->edge_rect.x;
+    node->edge_rect.height = ceil (MAX (node->dot_y, y_end) + CC_TOPOLOGY_DOT_RADIUS) -
+                             node->edge_rect.y;
+  }
+
+  g_array_set_size (self->separators, 0);
+  for (i = 0; i < self->separator_columns->len; i++)
+  {
+    x = (g_array_index (self->separator_columns, gint, i) + 0.5) * cell_width;
+    g_array_append_val (self->separators, x);
+  }
+
+  /* A new layout is painted in full, damage from the old one is moot. */
+  cairo_region_destroy (self->damage);
+  self->damage = cairo_region_create ();
+
+  return TRUE;
+}
+
+/* Separator positions of the last layout. */
+const gdouble *
+cc_security_topology_get_separators (CcSecurityTopology *self,
+                                     guint              *n_separators)
+{
+  *n_separators = self->separators->len;
+
+  return (const gdouble *) self->separators->data;
+}
+
+/* The cell of a node and wherever its icon or label spilled out of it. */
+void
+cc_security_topology_damage_node (CcSecurityTopology *self,
+                                  guint               index)
+{
+  CcTopologyNode *node;
+
+  g_return_if_fail (index < self->nodes->len);
+
+  node = g_ptr_array_index (self->nodes, index);
+  cairo_region_union_rectangle (self->damage, &node->rect);
+  cairo_region_union_rectangle (self->damage, &node->ink_rect);
+}
+
+/* The dots between a node and its parent. */
+void
+cc_security_topology_damage_edge (CcSecurityTopology *self,
+                                  guint               index)
+{
+  CcTopologyNode *node;
+
+  g_return_if_fail (index < self->nodes->len);
+
+  node = g_ptr_array_index (self->nodes, index);
+  if (node->parent >= 0)
+    cairo_region_union_rectangle (self->damage, &node->edge_rect);
+}
+
+/* Returns the damage since the last call, or NULL if there is none. Free
+ * with cairo_region_destroy(). */
+cairo_region_t *
+cc_security_topology_take_damage (CcSecurityTopology *self)
+{
+  cairo_region_t *damage;
+
+  if (cairo_region_is_empty (self->damage))
+    return NULL;
+
+  damage = self->damage;
+  self->damage = cairo_region_create ();
+
+  return damage;
+}
+
+/* Artwork is rendered from SVG at build time, to resource_dir/<n>x/
+ * <name>.png for each scale up to CC_TOPOLOGY_ICON_SCALES, so nothing is
+ * rasterized at runtime. The surface carries the scale, and paints at
+ * the logical size of the 1x image. */
+cairo_surface_t *
+cc_security_topology_load_icon (const char *resource_dir,
+                                const char *name,
+                                gint        scale)
+{
+  cairo_surface_t *surface;
+  GdkPixbuf *pixbuf;
+  GError *error = NULL;
+  gchar *path;
+
+  scale = CLAMP (scale, 1, CC_TOPOLOGY_ICON_SCALES);
+  path = g_strdup_printf ("%s/%dx/%s.png", resource_dir, scale, name);
+  pixbuf = gdk_pixbuf_new_from_resource (path, &error);
+  if (!pixbuf)
+  {
+    g_warning ("Could not load %s: %s", path, error->message);
+    g_clear_error (&error);
+    g_free (path);
+    return NULL;
+  }
+
+  surface = gdk_cairo_surface_create_from_pixbuf (pixbuf, scale, NULL);
+  g_object_unref (pixbuf);
+  g_free (path);
+
+  return surface;
+}
@@ -0,0 +1,110 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/*
+ * Copyright (C) 2020 gooroom <gooroom@gooroom.kr>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+
+
+#pragma once
+
+#include <gtk/gtk.h>
+
+G_BEGIN_DECLS
+
+/* Size of one layout cell at the natural size of the topology. */
+#define CC_TOPOLOGY_CELL_WIDTH      96
+#define CC_TOPOLOGY_CELL_HEIGHT     73
+
+/* Distance between the dots of a connection along each axis. */
+#define CC_TOPOLOGY_DOT_SPACING_X   20
+#define CC_TOPOLOGY_DOT_SPACING_Y   15
+#define CC_TOPOLOGY_DOTS             4
+
+/* Room around each dot for the largest radius it is drawn with. */
+#define CC_TOPOLOGY_DOT_RADIUS       6
+
+#define CC_TOPOLOGY_LABEL_SPACING    5
+
+/* Largest scale factor the artwork is rendered for at build time. */
+#define CC_TOPOLOGY_ICON_SCALES      2
+
+typedef struct
+{
+  gchar        *dbus_name;
+  gchar        *label;
+  gchar        *image;
+  cairo_surface_t *icon;
+  gint          column;
+  gint          row;
+  gint          parent;
+  gdouble       opacity;
+  gdouble       blink;
+  gint          color;
+
+  /* Filled in by the layout. */
+  GdkRectangle  rect;
+  GdkRectangle  edge_rect;
+  gdouble       dot_x;
+  gdouble       dot_y;
+  gdouble       dot_dx;
+  gdouble       dot_dy;
+
+  /* Filled in by the renderer, where the node was last painted. */
+  GdkRectangle  ink_rect;
+} CcTopologyNode;
+
+typedef struct _CcSecurityTopology CcSecurityTopology;
+
+CcSecurityTopology *cc_security_topology_new            (const char         *resource_dir,
+                                                         gint                scale);
+void                cc_security_topology_free           (CcSecurityTopology *self);
+gint                cc_security_topology_add_node       (CcSecurityTopology *self,
+                                                         const char         *dbus_name,
+                                                         const char         *label,
+                                                         const char         *image,
+                                                         gint                column,
+                                                         gint                row,
+                                                         gint                parent);
+void                cc_security_topology_remove_node    (CcSecurityTopology *self,
+                                                         guint               index);
+void                cc_security_topology_add_separator  (CcSecurityTopology *self,
+                                                         gint                column);
+void                cc_security_topology_set_scale      (CcSecurityTopology *self,
+                                                         gint                scale);
+guint               cc_security_topology_get_n_nodes    (CcSecurityTopology *self);
+CcTopologyNode     *cc_security_topology_get_node       (CcSecurityTopology *self,
+                                                         guint               index);
+void                cc_security_topology_get_size       (CcSecurityTopology *self,
+                                                         gint               *width,
+                                                         gint               *height);
+gboolean            cc_security_topology_layout         (CcSecurityTopology *self,
+                                                         gint                width,
+                                                         gint                height);
+const gdouble      *cc_security_topology_get_separators (CcSecurityTopology *self,
+                                                         guint              *n_separators);
+void                cc_security_topology_damage_node    (CcSecurityTopology *self,
+                                                         guint               index);
+void                cc_security_topology_damage_edge    (CcSecurityTopology *self,
+                                                         guint               index);
+cairo_region_t     *cc_security_topology_take_damage    (CcSecurityTopology *self);
+
+cairo_surface_t    *cc_security_topology_load_icon      (const char         *resource_dir,
+                                                         const char         *name,
+                                                         gint                scale);
+
+G_END_DECLS